@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../timer/timer.h"
+
+// Pi(n) on several threads, two methods:
+//   trial: trial division of every i < N, threads take blocks of i from a
+//          shared counter (the cost grows with i, so blocks balance it)
+//   sieve: segmented sieve of Eratosthenes, base primes up to sqrt(N),
+//          threads take segments of the range from a shared counter
+// usage: PIn_cpp_par.exe [trial|sieve] [threads] [N]
+
+int isPrime(int n) {
+  if (n < 2) return false;
+  for (int i = 2; i * i <= n; i++)
+    if (n % i == 0) return false;
+  return true;
+}
+
+// dynamic schedule: work(first, last) on blocks of size block of [0, n)
+template <typename Work>
+long parallel(long n, long block, int nthread, Work work) {
+  std::atomic<long> next{0};
+  std::vector<long> count(nthread, 0);
+  auto loop = [&](int id) {
+    for (long lo; (lo = next.fetch_add(block)) < n;)
+      count[id] += work(lo, std::min(n, lo + block));
+  };
+  std::vector<std::thread> pool;
+  for (int id = 1; id < nthread; ++id) pool.emplace_back(loop, id);
+  loop(0);
+  for (auto& t : pool) t.join();
+  long total = 0;
+  for (long c : count) total += c;
+  return total;
+}
+
+long trial(long N, int nthread) {
+  return parallel(N, 10000, nthread, [](long lo, long hi) {
+    long c = 0;
+    for (long i = lo; i < hi; ++i) c += isPrime(static_cast<int>(i));
+    return c;
+  });
+}
+
+long sieve(long N, int nthread) {
+  // base primes up to sqrt(N)
+  long root = 1;
+  while ((root + 1) * (root + 1) < N) ++root;
+  std::vector<char> small(root + 1, 1);
+  std::vector<long> base;
+  for (long i = 2; i <= root; ++i) {
+    if (!small[i]) continue;
+    base.push_back(i);
+    for (long j = i * i; j <= root; j += i) small[j] = 0;
+  }
+  // 256 kB segments, about the size of the L2 cache
+  const long segment = 1 << 18;
+  return parallel(N, segment, nthread, [&](long lo, long hi) {
+    std::vector<char> mark(hi - lo, 1);
+    for (long p : base) {
+      if (p * p >= hi) break;
+      long start = std::max(p * p, (lo + p - 1) / p * p);
+      for (long j = start; j < hi; j += p) mark[j - lo] = 0;
+    }
+    long c = 0;
+    for (long i = std::max(lo, 2L); i < hi; ++i) c += mark[i - lo];
+    return c;
+  });
+}
+
+int main(int argc, char* argv[]) {
+  std::string method = (argc > 1) ? argv[1] : "sieve";
+  int nthread = (argc > 2) ? std::stoi(argv[2])
+                           : std::max(1u, std::thread::hardware_concurrency());
+  long N = (argc > 3) ? std::stol(argv[3]) : 5000000;
+
+  Timer timer;
+
+  long primes = (method == "trial") ? trial(N, nthread) : sieve(N, nthread);
+
+  double elapsed = timer.elapsed();
+  std::cout << "C++ (" << method << ", " << nthread << " threads)" << std::endl;
+  std::cout << "result: " << std::setw(8) << primes << " primes in "
+            << std::setw(8) << N << std::endl;
+  std::cout << "time: " << std::setw(10) << elapsed << " seconds."
+            << std::endl;
+  std::cout << "csv: C++," << method << ',' << nthread << ',' << N << ','
+            << primes << ',' << elapsed << std::endl;
+}
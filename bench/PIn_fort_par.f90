@@ -0,0 +1,122 @@
+! Pi(n) on several OpenMP threads, two methods:
+!   trial: trial division of every i < N, dynamic schedule over blocks of i
+!   sieve: segmented sieve of Eratosthenes, base primes up to sqrt(N),
+!          dynamic schedule over the segments
+! usage: PIn_fort_par.exe [trial|sieve] [threads] [N]
+
+function isprime(n)
+  implicit none
+  integer, intent(in) :: n
+  logical :: isprime
+  integer :: i
+  isprime = .false.
+  if(n < 2) return
+  i = 2
+  do while(i*i <= n)
+    if(mod(n,i) == 0) return
+    i = i + 1
+  enddo
+  isprime = .true.
+end function isprime
+
+module sieve_mod
+  implicit none
+  integer, parameter :: segment = 262144  ! 256 kB of logical(1)
+contains
+  integer(8) function trial(N)
+    integer, intent(in) :: N
+    logical, external :: isprime
+    integer :: i
+    trial = 0
+    !$omp parallel do schedule(dynamic,10000) reduction(+:trial)
+    do i = 0,N-1
+      if(isprime(i)) trial = trial + 1
+    enddo
+    !$omp end parallel do
+  end function trial
+
+  integer(8) function sieve(N)
+    integer, intent(in) :: N
+    integer :: root, i, j, k, p, lo, hi, start, nbase, nseg, s
+    ! logical(1): one byte per number, as in the other languages
+    logical(1), allocatable :: small(:), mark(:)
+    integer, allocatable :: base(:)
+    ! base primes up to sqrt(N)
+    root = 1
+    do while(int(root+1,8)*(root+1) < N)
+      root = root + 1
+    enddo
+    allocate(small(0:root), base(root))
+    small = .true.
+    nbase = 0
+    do i = 2,root
+      if(.not. small(i)) cycle
+      nbase = nbase + 1
+      base(nbase) = i
+      do j = i*i,root,i
+        small(j) = .false.
+      enddo
+    enddo
+    ! one segment [lo, hi) per iteration
+    nseg = (N + segment - 1) / segment
+    sieve = 0
+    !$omp parallel do schedule(dynamic) reduction(+:sieve) &
+    !$omp private(mark,lo,hi,k,p,start,j)
+    do s = 0,nseg-1
+      lo = s * segment
+      hi = min(N, lo + segment)
+      allocate(mark(lo:hi-1))
+      mark = .true.
+      do k = 1,nbase
+        p = base(k)
+        if(int(p,8)*p >= hi) exit
+        start = max(p*p, (lo + p - 1) / p * p)
+        do j = start,hi-1,p
+          mark(j) = .false.
+        enddo
+      enddo
+      sieve = sieve + count(mark(max(lo,2):hi-1))
+      deallocate(mark)
+    enddo
+    !$omp end parallel do
+  end function sieve
+end module sieve_mod
+
+program main
+  use sieve_mod
+  use omp_lib
+  implicit none
+  integer :: N, nthread
+  integer(8) :: primes
+  integer(8) :: tstart,tstop,rate
+  double precision :: secs
+  character(len=16) :: method, arg, csvtime
+
+  method = 'sieve'
+  nthread = omp_get_max_threads()
+  N = 5000000
+  if(command_argument_count() >= 1) call get_command_argument(1, method)
+  if(command_argument_count() >= 2) then
+    call get_command_argument(2, arg);  read(arg,*) nthread
+  endif
+  if(command_argument_count() >= 3) then
+    call get_command_argument(3, arg);  read(arg,*) N
+  endif
+  call omp_set_num_threads(nthread)
+  call system_clock(tstart,rate)
+
+  if(trim(method) == 'trial') then
+    primes = trial(N)
+  else
+    primes = sieve(N)
+  endif
+
+  call system_clock(tstop,rate)
+  secs = dble(tstop-tstart)/dble(rate)
+  write(csvtime,'(f16.6)') secs
+  write(*,('(a,a,a,i0,a)')) "Fortran (",trim(method),", ",nthread," threads)"
+  write(*,('(a,i8,a,i9)')) "result: ",primes," primes in ",N
+  write(*,('(a,f10.6,a)')) "time: ",secs," seconds."
+  write(*,('(a,a,a,i0,a,i0,a,i0,a,a)')) "csv: Fortran,",trim(method),",", &
+    nthread,",",N,",",primes,",",trim(adjustl(csvtime))
+end program main
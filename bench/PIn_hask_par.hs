@@ -0,0 +1,102 @@
+-- Pi(n) on several threads, two methods:
+--   trial: trial division of every i < N, threads take blocks of i from a
+--          shared counter (the cost grows with i, so blocks balance it)
+--   sieve: segmented sieve of Eratosthenes, base primes up to sqrt(N),
+--          threads take segments of the range from a shared counter
+-- usage: PIn_hask_par.exe [trial|sieve] [threads] [N]
+-- build with -threaded, only base and array are needed
+import Control.Concurrent
+import Control.Exception (evaluate)
+import Control.Monad
+import Data.Array.ST
+import Data.Array.Unboxed
+import Data.IORef
+import Data.Time
+import System.Environment
+import Text.Printf
+
+isPrime :: Int -> Bool
+isPrime n
+  | n < 2 = False
+  | otherwise = go 2
+  where
+    go i
+      | i * i > n = True
+      | n `rem` i == 0 = False
+      | otherwise = go (i + 1)
+
+-- dynamic schedule: work lo hi on blocks of size block of [0, n)
+parallel :: Int -> Int -> Int -> (Int -> Int -> Int) -> IO Int
+parallel n block nthread work = do
+  next <- newIORef 0
+  results <- forM [1 .. nthread] $ \_ -> do
+    done <- newEmptyMVar
+    _ <- forkIO $ do
+      let loop acc = do
+            lo <- atomicModifyIORef' next (\i -> (i + block, i))
+            if lo >= n
+              then return acc
+              else do
+                c <- evaluate (work lo (min n (lo + block)))
+                loop $! acc + c
+      loop 0 >>= putMVar done
+    return done
+  sum <$> mapM takeMVar results
+
+trial :: Int -> Int -> IO Int
+trial n nthread = parallel n 10000 nthread $ \lo hi ->
+  length (filter isPrime [lo .. hi - 1])
+
+-- primes up to root
+basePrimes :: Int -> [Int]
+basePrimes root = [i | (i, True) <- assocs small, i <= root]
+  where
+    small :: UArray Int Bool
+    small = runSTUArray $ do
+      a <- newArray (2, max 2 root) True
+      forM_ [2 .. root] $ \i -> do
+        isP <- readArray a i
+        when (isP && i * i <= root) $
+          forM_ [i * i, i * i + i .. root] $ \j -> writeArray a j False
+      return a
+
+-- primes in [lo, hi)
+segmentCount :: [Int] -> Int -> Int -> Int
+segmentCount base lo hi = length [i | (i, True) <- assocs mark, i >= 2]
+  where
+    mark :: UArray Int Bool
+    mark = runSTUArray $ do
+      a <- newArray (lo, hi - 1) True
+      forM_ (takeWhile (\p -> p * p < hi) base) $ \p -> do
+        let start = max (p * p) (((lo + p - 1) `div` p) * p)
+        forM_ [start, start + p .. hi - 1] $ \j -> writeArray a j False
+      return a
+
+sieve :: Int -> Int -> IO Int
+sieve n nthread = do
+  -- root >= 1 as in the other languages, so n <= 1 gives no base primes
+  -- and no primes
+  let root = last (1 : takeWhile (\r -> r * r < n) [2 ..])
+      base = basePrimes root
+  _ <- evaluate (length base)
+  -- 262144 numbers per segment as in the other languages, but UArray Bool
+  -- packs them into bits, so a segment is only 32 kB
+  parallel n 262144 nthread (segmentCount base)
+
+main :: IO ()
+main = do
+  args <- getArgs
+  ncap <- getNumCapabilities
+  let method = if length args > 0 then args !! 0 else "sieve"
+      nthread = if length args > 1 then read (args !! 1) else ncap
+      n = if length args > 2 then read (args !! 2) else 5000000
+  setNumCapabilities nthread
+  start <- getCurrentTime
+  primeCount <- if method == "trial" then trial n nthread else sieve n nthread
+  end <- getCurrentTime
+  let duration = realToFrac (diffUTCTime end start) :: Double
+
+  printf "Haskell (%s, %d threads)\n" method nthread
+  printf "result: %8d primes in %8d\n" primeCount n
+  printf "time: %10.6f seconds.\n" duration
+  printf "csv: Haskell,%s,%d,%d,%d,%.6f\n" method nthread n primeCount duration
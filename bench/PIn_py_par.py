@@ -0,0 +1,70 @@
+# Pi(n) on several processes, two methods:
+#   trial: trial division of every i < N, workers take blocks of i
+#          (the cost grows with i, so blocks balance it)
+#   sieve: segmented sieve of Eratosthenes, base primes up to sqrt(N),
+#          workers take segments of the range
+# usage: PIn_py_par.exe [trial|sieve] [threads] [N]
+# Processes instead of threads, as the GIL serializes Python threads.
+import math
+import multiprocessing
+import os
+import sys
+import time
+
+SEGMENT = 1 << 18  # 256 kB segments, about the size of the L2 cache
+
+def isPrime(n):
+  if(n < 2):
+    return False
+  for i in range(2,math.isqrt(n)+1):
+    if(n%i==0):
+      return False
+  return True
+
+def trialBlock(block):
+  lo, hi = block
+  return sum(isPrime(i) for i in range(lo,hi))
+
+def basePrimes(root):
+  small = bytearray([1])*(root+1)
+  for i in range(2,math.isqrt(root)+1):
+    if(small[i]):
+      small[i*i::i] = bytearray(len(range(i*i,root+1,i)))
+  return [i for i in range(2,root+1) if small[i]]
+
+BASE = []
+
+def sieveBlock(block):
+  lo, hi = block
+  mark = bytearray([1])*(hi-lo)
+  for p in BASE:
+    if(p*p >= hi):
+      break
+    start = max(p*p,(lo+p-1)//p*p)
+    mark[start-lo::p] = bytearray(len(range(start,hi,p)))
+  return sum(mark[max(lo,2)-lo:])
+
+def blocks(n,size):
+  return [(lo,min(n,lo+size)) for lo in range(0,n,size)]
+
+if __name__ == "__main__":
+  method = sys.argv[1] if len(sys.argv) > 1 else "sieve"
+  nthread = int(sys.argv[2]) if len(sys.argv) > 2 else os.cpu_count()
+  N = int(sys.argv[3]) if len(sys.argv) > 3 else 5000000
+
+  start_time = time.time()
+
+  if(method == "trial"):
+    work, size = trialBlock, 10000
+  else:
+    BASE = basePrimes(max(1,math.isqrt(max(N-1,0))))  # N = 0 as well
+    work, size = sieveBlock, SEGMENT
+  # forked workers inherit BASE
+  with multiprocessing.get_context("fork").Pool(nthread) as pool:
+    primes = sum(pool.imap_unordered(work,blocks(N,size)))
+
+  end_time = time.time()
+  print(f"Python ({method}, {nthread} threads)")
+  print(f"result: {primes:8} primes in {N:8}")
+  print(f"time: {(end_time-start_time):10.6f} seconds.")
+  print(f"csv: Python,{method},{nthread},{N},{primes},{(end_time-start_time):.6f}")
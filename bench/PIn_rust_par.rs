@@ -0,0 +1,112 @@
+// Pi(n) on several threads, two methods:
+//   trial: trial division of every i < N, threads take blocks of i from a
+//          shared counter (the cost grows with i, so blocks balance it)
+//   sieve: segmented sieve of Eratosthenes, base primes up to sqrt(N),
+//          threads take segments of the range from a shared counter
+// usage: PIn_rust_par.exe [trial|sieve] [threads] [N]
+// std::thread only, so it builds with plain rustc like PIn_rust.rs
+use std::env;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::thread;
+use std::time::Instant;
+
+fn isprime(n: u64) -> bool {
+  if n < 2 {
+    return false;
+  }
+  let mut i = 2;
+  while i * i <= n {
+    if n % i == 0 {
+      return false;
+    }
+    i += 1;
+  }
+  true
+}
+
+// dynamic schedule: work(first, last) on blocks of size block of [0, n)
+fn parallel<F>(n: u64, block: u64, nthread: usize, work: F) -> u64
+where
+  F: Fn(u64, u64) -> u64 + Sync,
+{
+  let next = AtomicU64::new(0);
+  thread::scope(|s| {
+    let handles: Vec<_> = (0..nthread)
+      .map(|_| {
+        s.spawn(|| {
+          let mut count = 0;
+          loop {
+            let lo = next.fetch_add(block, Ordering::Relaxed);
+            if lo >= n {
+              break;
+            }
+            count += work(lo, (lo + block).min(n));
+          }
+          count
+        })
+      })
+      .collect();
+    handles.into_iter().map(|h| h.join().unwrap()).sum()
+  })
+}
+
+fn trial(n: u64, nthread: usize) -> u64 {
+  parallel(n, 10000, nthread, |lo, hi| (lo..hi).filter(|&i| isprime(i)).count() as u64)
+}
+
+fn sieve(n: u64, nthread: usize) -> u64 {
+  // base primes up to sqrt(N)
+  let mut root = 1;
+  while (root + 1) * (root + 1) < n {
+    root += 1;
+  }
+  let mut small = vec![true; (root + 1) as usize];
+  let mut base = Vec::new();
+  for i in 2..=root {
+    if !small[i as usize] {
+      continue;
+    }
+    base.push(i);
+    let mut j = i * i;
+    while j <= root {
+      small[j as usize] = false;
+      j += i;
+    }
+  }
+  // 256 kB segments, about the size of the L2 cache
+  let segment = 1 << 18;
+  parallel(n, segment, nthread, |lo, hi| {
+    let mut mark = vec![true; (hi - lo) as usize];
+    for &p in &base {
+      if p * p >= hi {
+        break;
+      }
+      let mut j = (p * p).max((lo + p - 1) / p * p);
+      while j < hi {
+        mark[(j - lo) as usize] = false;
+        j += p;
+      }
+    }
+    (lo.max(2)..hi).filter(|&i| mark[(i - lo) as usize]).count() as u64
+  })
+}
+
+fn main() {
+  let args: Vec<String> = env::args().collect();
+  let method = args.get(1).map(|s| s.as_str()).unwrap_or("sieve").to_string();
+  let nthread: usize = args
+    .get(2)
+    .map(|s| s.parse().unwrap())
+    .unwrap_or_else(|| thread::available_parallelism().map(|n| n.get()).unwrap_or(1));
+  let n: u64 = args.get(3).map(|s| s.parse().unwrap()).unwrap_or(5_000_000);
+
+  let start = Instant::now();
+
+  let primes = if method == "trial" { trial(n, nthread) } else { sieve(n, nthread) };
+
+  let duration = start.elapsed();
+  println!("Rust ({}, {} threads)", method, nthread);
+  println!("result: {:8} primes in {:8}", primes, n);
+  println!("time: {:10.6} seconds.", duration.as_secs_f64());
+  println!("csv: Rust,{},{},{},{},{:.6}", method, nthread, n, primes, duration.as_secs_f64());
+}
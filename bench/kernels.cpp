@@ -0,0 +1,286 @@
+#include <gsl/gsl_monte.h>
+#include <gsl/gsl_monte_vegas.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gaussleg.h"
+#include "process.h"
+#include "processes.h"
+
+// Microbenchmarks of the kernels of incjet and gauss:
+//   parton          cteqpdf::parton, all 11 flavours at one (x, Q)
+//   alphas          cteqpdf::alphas at one Q
+//   integrand_jet   integrand<jet> at one phase-space point
+//   gaussleg<N>     GaussLeg::integrate<N> of a smooth function
+//   vegas_gauss     one VEGAS iteration of 10^4 calls, cheap integrand
+//   vegas_jet       one VEGAS iteration of 10^4 calls, integrand<jet>
+// The inputs are drawn once from a fixed seed, so every run times the same
+// work: x log-uniform in [1e-5, 0.9] and Q log-uniform in [5, 1000] GeV,
+// the range of the jet bins at 2.76 - 5.02 TeV. The VEGAS grids are
+// adapted before any timing, but keep adapting with every iteration, so
+// the repetitions of vegas_* sample slightly different points.
+// Each benchmark runs warmup untimed and reps timed repetitions of a fixed
+// batch of items, and reports statistics of the time per repetition and
+// the median time per item.
+
+// options of a run
+struct benchoptions {
+  int warmup = 3;
+  int reps = 20;
+  int cpu = -1;         // pin to this CPU, -1: no pinning
+  bool json = false;
+  std::string filter;   // only benchmarks whose name contains this
+  std::string pdffile = "../incjet/i2TAn2.00.pds";
+};
+
+// one benchmark: a batch of items per repetition
+struct kernel {
+  std::string name;
+  size_t items;
+  std::function<double()> batch;  // returns a checksum, kept alive
+};
+
+// statistics of one benchmark, times in nanoseconds
+struct timing {
+  std::string name;
+  size_t items;
+  int reps;
+  double min, median, mean, stddev, per_item;
+  double checksum;
+};
+
+volatile double sink;  // keeps the checksums from being optimized away
+
+timing measure(const kernel& k, const benchoptions& o) {
+  for (int i = 0; i < o.warmup; ++i) sink = k.batch();
+  std::vector<double> t(o.reps);
+  double checksum = 0.0;
+  for (int i = 0; i < o.reps; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    checksum = k.batch();
+    auto end = std::chrono::steady_clock::now();
+    t[i] = std::chrono::duration<double, std::nano>(end - start).count();
+    sink = checksum;
+  }
+  std::sort(t.begin(), t.end());
+  timing r{k.name, k.items, o.reps, t.front(), 0.0, 0.0, 0.0, 0.0, checksum};
+  size_t n = t.size();
+  r.median = (n % 2 == 1) ? t[n / 2] : 0.5 * (t[n / 2 - 1] + t[n / 2]);
+  for (double v : t) r.mean += v / n;
+  for (double v : t) r.stddev += (v - r.mean) * (v - r.mean);
+  r.stddev = (n > 1) ? std::sqrt(r.stddev / (n - 1)) : 0.0;
+  r.per_item = r.median / k.items;
+  return r;
+}
+
+void print(std::ostream& out, const std::vector<timing>& res,
+           const benchoptions& o) {
+  out << std::setprecision(6);
+  if (o.json) {
+    out << "{\n  \"warmup\": " << o.warmup << ",\n  \"reps\": " << o.reps
+        << ",\n  \"cpu\": " << o.cpu << ",\n  \"compiler\": \"" << __VERSION__
+        << "\",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < res.size(); ++i) {
+      const timing& r = res[i];
+      out << "    {\"name\": \"" << r.name << "\", \"items\": " << r.items
+          << ", \"reps\": " << r.reps << ", \"min_ns\": " << r.min
+          << ", \"median_ns\": " << r.median << ", \"mean_ns\": " << r.mean
+          << ", \"stddev_ns\": " << r.stddev
+          << ", \"ns_per_item\": " << r.per_item
+          << ", \"checksum\": " << r.checksum << "}"
+          << (i + 1 < res.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+  } else {
+    out << "name,items,reps,min_ns,median_ns,mean_ns,stddev_ns,ns_per_item,"
+           "checksum\n";
+    for (const timing& r : res)
+      out << r.name << ',' << r.items << ',' << r.reps << ',' << r.min << ','
+          << r.median << ',' << r.mean << ',' << r.stddev << ','
+          << r.per_item << ',' << r.checksum << "\n";
+  }
+}
+
+// pin the process to one CPU, so repetitions do not migrate
+bool pin(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+// one VEGAS iteration of ncall calls per batch, on a grid adapted by a
+// warm-up run of the same integrand in the constructor
+class vegasloop {
+ public:
+  static constexpr size_t ncall = 10000;
+  vegasloop(gsl_monte_function gmf, const double* lo, const double* hi)
+      : f(gmf), lower(lo, lo + gmf.dim), upper(hi, hi + gmf.dim) {
+    r = gsl_rng_alloc(gsl_rng_default);
+    s = gsl_monte_vegas_alloc(f.dim);
+    double res, err;
+    gsl_monte_vegas_integrate(&f, lower.data(), upper.data(), f.dim, ncall,
+                              r, s, &res, &err);
+    gsl_monte_vegas_params vp;
+    gsl_monte_vegas_params_get(s, &vp);
+    vp.stage = 2;
+    vp.iterations = 1;
+    gsl_monte_vegas_params_set(s, &vp);
+  }
+  vegasloop(const vegasloop&) = delete;
+  vegasloop& operator=(const vegasloop&) = delete;
+  ~vegasloop() {
+    gsl_monte_vegas_free(s);
+    gsl_rng_free(r);
+  }
+  double operator()() {
+    double res, err;
+    gsl_monte_vegas_integrate(&f, lower.data(), upper.data(), f.dim, ncall,
+                              r, s, &res, &err);
+    return res;
+  }
+
+ private:
+  gsl_monte_function f;
+  std::vector<double> lower, upper;
+  gsl_rng* r;
+  gsl_monte_vegas_state* s;
+};
+
+// nint N-point rules on slightly different intervals
+template <int N, typename Func>
+kernel gaussleg(size_t nint, Func f) {
+  return {"gaussleg" + std::to_string(N), nint, [nint, f] {
+            double sum = 0.0;
+            for (size_t i = 0; i < nint; ++i)
+              sum += GaussLeg::integrate<N>(0.0, 1.0 + 1e-4 * i, f);
+            return sum;
+          }};
+}
+
+double gauss3(double* x, size_t, void*) {
+  return std::exp(-50.0 * ((x[0] - 0.5) * (x[0] - 0.5) +
+                           (x[1] - 0.5) * (x[1] - 0.5) +
+                           (x[2] - 0.5) * (x[2] - 0.5)));
+}
+
+// main function
+int main(int argc, char* argv[]) {
+  // command line options
+  // --json:          JSON instead of CSV
+  // --reps <n>:      timed repetitions, default 20
+  // --warmup <n>:    untimed repetitions before, default 3, at least 1
+  // --cpu <n>:       pin to CPU n
+  // --filter <s>:    only benchmarks whose name contains s
+  // --pdf <file>:    PDF table, default ../incjet/i2TAn2.00.pds
+  benchoptions o;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--json") {
+      o.json = true;
+    } else if (arg == "--reps" && i + 1 < argc) {
+      o.reps = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--warmup" && i + 1 < argc) {
+      o.warmup = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--cpu" && i + 1 < argc) {
+      o.cpu = std::stoi(argv[++i]);
+    } else if (arg == "--filter" && i + 1 < argc) {
+      o.filter = argv[++i];
+    } else if (arg == "--pdf" && i + 1 < argc) {
+      o.pdffile = argv[++i];
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--json] [--reps n] [--warmup n] [--cpu n] [--filter s]"
+                   " [--pdf file]"
+                << std::endl;
+      return 1;
+    }
+  }
+  if (o.cpu >= 0 && !pin(o.cpu)) {
+    std::cerr << "Error: unable to pin to CPU " << o.cpu << std::endl;
+    return 1;
+  }
+  gsl_rng_env_setup();
+  // jet settings of incjet.cpp
+  parameters<jet> p;
+  p.CME = 5020.0;
+  p.ptmin = 40.0;
+  p.ptmax = 1000.0;
+  p.ymin = -2.8;
+  p.ymax = +2.8;
+  p.ct18anlo.setct11(o.pdffile);
+  // fixed inputs
+  const size_t npoint = 4096;
+  std::mt19937_64 rng(20240101);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::vector<double> xs(npoint), qs(npoint), dx(3 * npoint);
+  for (size_t i = 0; i < npoint; ++i) {
+    xs[i] = 1e-5 * std::pow(0.9 / 1e-5, u(rng));
+    qs[i] = 5.0 * std::pow(1000.0 / 5.0, u(rng));
+    // phase-space points that pass the kinematic limits
+    phasespace ps;
+    double* d = &dx[3 * i];
+    do {
+      d[0] = u(rng);
+      d[1] = p.ymin + (p.ymax - p.ymin) * u(rng);
+      d[2] = p.ptmin * std::pow(p.ptmax / p.ptmin, u(rng));
+    } while (!jet::kinematics(d, p, ps));
+  }
+  auto smooth = [](double x) { return std::exp(-x) * std::cos(3.0 * x); };
+
+  std::vector<kernel> kernels;
+  kernels.push_back({"parton", npoint * (2 * Nf + 1), [&] {
+                       double sum = 0.0;
+                       for (size_t i = 0; i < npoint; ++i)
+                         for (int f = -Nf; f <= Nf; ++f)
+                           sum += p.ct18anlo.parton(f, xs[i], qs[i]);
+                       return sum;
+                     }});
+  kernels.push_back({"alphas", npoint, [&] {
+                       double sum = 0.0;
+                       for (size_t i = 0; i < npoint; ++i)
+                         sum += p.ct18anlo.alphas(qs[i]);
+                       return sum;
+                     }});
+  kernels.push_back({"integrand_jet", npoint, [&] {
+                       double sum = 0.0;
+                       for (size_t i = 0; i < npoint; ++i)
+                         sum += integrand<jet>(&dx[3 * i], jet::ndim, &p);
+                       return sum;
+                     }});
+  const size_t nint = 10000;
+  kernels.push_back(gaussleg<8>(nint, smooth));
+  kernels.push_back(gaussleg<16>(nint, smooth));
+  kernels.push_back(gaussleg<32>(nint, smooth));
+  kernels.push_back(gaussleg<64>(nint, smooth));
+  // VEGAS on a cheap integrand (the VEGAS overhead) and on the jet bin
+  // 100 - 105 GeV, with the grid warm-up here and not in a timed batch
+  double glo[3] = {0.0, 0.0, 0.0}, ghi[3] = {1.0, 1.0, 1.0};
+  double jlo[3], jhi[3];
+  jet::limits(p, 100.0, 105.0, jlo, jhi);
+  vegasloop vgauss({&gauss3, 3, nullptr}, glo, ghi);
+  vegasloop vjet({&integrand<jet>, 3, &p}, jlo, jhi);
+  kernels.push_back({"vegas_gauss", vegasloop::ncall, [&] {
+                       return vgauss();
+                     }});
+  kernels.push_back({"vegas_jet", vegasloop::ncall, [&] {
+                       return vjet();
+                     }});
+
+  std::vector<timing> res;
+  for (const kernel& k : kernels)
+    if (k.name.find(o.filter) != std::string::npos)
+      res.push_back(measure(k, o));
+  print(std::cout, res, o);
+  return 0;
+}
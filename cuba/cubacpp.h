@@ -0,0 +1,162 @@
+#ifndef CUBACPP_H
+#define CUBACPP_H
+
+#include <cuba.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// C++ interface to the four Cuba integrators (Cuba 4.2).
+// The integrand is any callable, in one of two forms:
+//   f(const double* x, double* fx)         one point x[ndim], fx[ncomp]
+//   f(const double* x, double* fx, int n)  n <= nvec points at once,
+//                                          x[n*ndim] and fx[n*ncomp]
+// with x in the unit hypercube, as always in Cuba. The batched form gets
+// up to cubaoptions::nvec points per call, so a vectorized integrand pays
+// its set-up once per batch.
+//
+// Parallel runs: Cuba forks ncores worker processes (cores() or the
+// CUBACORES environment variable). Each worker has its own copy of the
+// whole program, so an integrand with internal state, like cteqpdf, needs
+// no locking. With a cubaspin the workers stay alive between calls, but
+// then they keep the memory of the first call: only reuse them for the
+// same integrand with the same data.
+//
+// Usage:
+//   auto r = Cuba::vegas([](const double* x, double* f) { f[0] = ...; }, 3);
+//   r.integral[0], r.error[0], r.prob[0], r.neval, r.fail
+
+// common and algorithm specific settings, see the Cuba manual
+struct cubaoptions {
+  double epsrel = 1e-3, epsabs = 0.0;  // requested accuracy
+  int flags = 0;                       // verbosity and sampling flags
+  int seed = 0;                        // 0: Sobol quasi-random numbers
+  int mineval = 0, maxeval = 1000000;  // evaluation budget
+  int nvec = 1;                        // points per integrand call
+  const char* statefile = nullptr;     // state file, nullptr for none
+  // Vegas
+  int nstart = 1000, nincrease = 500, nbatch = 1000, gridno = 0;
+  // Suave
+  int nnew = 1000, nmin = 2;
+  double flatness = 25.0;
+  // Divonne
+  int key1 = 47, key2 = 1, key3 = 1, maxpass = 5;
+  double border = 0.0, maxchisq = 10.0, mindeviation = 0.25;
+  // Cuhre (and Divonne's final integration)
+  int key = 0;
+};
+
+// running worker processes, stopped when this goes out of scope
+struct cubaspin {
+  void* handle = nullptr;
+  cubaspin() = default;
+  cubaspin(const cubaspin&) = delete;
+  cubaspin& operator=(const cubaspin&) = delete;
+  ~cubaspin() {
+    if (handle) cubawait(&handle);
+  }
+};
+
+class Cuba {
+ public:
+  struct Result {
+    std::vector<double> integral, error, prob;  // one per component
+    int neval = 0;     // number of evaluations
+    int fail = 0;      // 0: accuracy reached, > 0: not reached, < 0: error
+    int nregions = 0;  // number of subregions (not for Vegas)
+    explicit Result(int ncomp) : integral(ncomp), error(ncomp), prob(ncomp) {}
+  };
+
+  // ncores workers plus the master; the master does up to pcores points
+  // itself before it hands batches to the workers; ncores = 0 is serial
+  static void cores(int ncores, int pcores = 10000) {
+    cubacores(&ncores, &pcores);
+  }
+
+  template <typename Func>
+  static Result vegas(Func&& f, int ndim, int ncomp = 1,
+                      const cubaoptions& o = cubaoptions(),
+                      cubaspin* spin = nullptr) {
+    Result r(ncomp);
+    Vegas(ndim, ncomp, entry<Func>(), data(f), o.nvec, o.epsrel, o.epsabs, o.flags,
+          o.seed, o.mineval, o.maxeval, o.nstart, o.nincrease, o.nbatch,
+          o.gridno, o.statefile, handle(spin), &r.neval, &r.fail,
+          r.integral.data(), r.error.data(), r.prob.data());
+    return r;
+  }
+
+  template <typename Func>
+  static Result suave(Func&& f, int ndim, int ncomp = 1,
+                      const cubaoptions& o = cubaoptions(),
+                      cubaspin* spin = nullptr) {
+    Result r(ncomp);
+    Suave(ndim, ncomp, entry<Func>(), data(f), o.nvec, o.epsrel, o.epsabs, o.flags,
+          o.seed, o.mineval, o.maxeval, o.nnew, o.nmin, o.flatness,
+          o.statefile, handle(spin), &r.nregions, &r.neval, &r.fail,
+          r.integral.data(), r.error.data(), r.prob.data());
+    return r;
+  }
+
+  template <typename Func>
+  static Result divonne(Func&& f, int ndim, int ncomp = 1,
+                        const cubaoptions& o = cubaoptions(),
+                        cubaspin* spin = nullptr) {
+    Result r(ncomp);
+    Divonne(ndim, ncomp, entry<Func>(), data(f), o.nvec, o.epsrel, o.epsabs,
+            o.flags, o.seed, o.mineval, o.maxeval, o.key1, o.key2, o.key3,
+            o.maxpass, o.border, o.maxchisq, o.mindeviation, 0, ndim,
+            nullptr, 0, nullptr, o.statefile, handle(spin), &r.nregions,
+            &r.neval, &r.fail, r.integral.data(), r.error.data(),
+            r.prob.data());
+    return r;
+  }
+
+  template <typename Func>
+  static Result cuhre(Func&& f, int ndim, int ncomp = 1,
+                      const cubaoptions& o = cubaoptions(),
+                      cubaspin* spin = nullptr) {
+    Result r(ncomp);
+    Cuhre(ndim, ncomp, entry<Func>(), data(f), o.nvec, o.epsrel, o.epsabs, o.flags,
+          o.mineval, o.maxeval, o.key, o.statefile, handle(spin),
+          &r.nregions, &r.neval, &r.fail, r.integral.data(), r.error.data(),
+          r.prob.data());
+    return r;
+  }
+
+ private:
+  template <typename Func>
+  static void* data(Func& f) {
+    return const_cast<void*>(static_cast<const void*>(&f));
+  }
+  static void* handle(cubaspin* spin) {
+    return spin ? static_cast<void*>(&spin->handle) : nullptr;
+  }
+
+  // Cuba calls the integrand with the nvec form of the C prototype,
+  // userdata is the callable
+  template <typename Func>
+  static int call(const int* ndim, const double x[], const int* ncomp,
+                  double f[], void* userdata, const int* nvec, const int*) {
+    auto& fn = *static_cast<std::remove_reference_t<Func>*>(userdata);
+    if constexpr (std::is_invocable_v<decltype(fn), const double*, double*,
+                                      int>) {
+      fn(x, f, *nvec);
+    } else {
+      for (int i = 0; i < *nvec; ++i)
+        fn(x + static_cast<size_t>(i) * *ndim,
+           f + static_cast<size_t>(i) * *ncomp);
+    }
+    return 0;
+  }
+
+  // the header declares integrand_t without the nvec and core arguments,
+  // the cast through void (*)() is the one that does not warn
+  template <typename Func>
+  static integrand_t entry() {
+    auto generic = reinterpret_cast<void (*)()>(&call<Func>);
+    return reinterpret_cast<integrand_t>(generic);
+  }
+};
+
+#endif  // CUBACPP_H
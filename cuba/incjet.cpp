@@ -0,0 +1,78 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../incjet/process.h"
+#include "../incjet/processes.h"
+#include "cubacpp.h"
+#include "../timer/timer.h"
+
+// Single inclusive jet cross section of ../incjet with Cuba Vegas, which
+// spreads the points of every bin over ncores forked worker processes.
+// The physics is the unchanged integrand<P> of process.h; each worker has
+// its own copy of the PDF, so nothing in it has to be thread safe.
+
+// one pt bin of process P: map the unit hypercube onto the limits of the
+// bin and evaluate a batch of n points
+template <typename P>
+Cuba::Result cubabin(parameters<P>& p, double binL, double binR,
+                     const cubaoptions& o) {
+  double lower[P::ndim], upper[P::ndim], jacobian = 1.0;
+  P::limits(p, binL, binR, lower, upper);
+  for (size_t k = 0; k < P::ndim; ++k) jacobian *= upper[k] - lower[k];
+  auto f = [&](const double* x, double* fx, int n) {
+    double dx[P::ndim];
+    for (int i = 0; i < n; ++i) {
+      for (size_t k = 0; k < P::ndim; ++k)
+        dx[k] = lower[k] + (upper[k] - lower[k]) * x[i * P::ndim + k];
+      fx[i] = jacobian * integrand<P>(dx, P::ndim, &p);
+    }
+  };
+  return Cuba::vegas(f, P::ndim, 1, o);
+}
+
+// main program
+int main(int argc, char* argv[]) {
+  // command line: ncores [nvec [epsrel [maxeval]]]
+  int ncores = (argc > 1) ? std::stoi(argv[1]) : 0;
+  cubaoptions o;
+  o.nvec = (argc > 2) ? std::stoi(argv[2]) : 100;
+  o.epsrel = (argc > 3) ? std::stod(argv[3]) : 1e-3;
+  o.maxeval = (argc > 4) ? std::stoi(argv[4]) : 1000000;
+  o.mineval = 100000;
+  Cuba::cores(ncores);
+  // start program timer
+  Timer timer;
+  // same settings as incjet.cpp
+  parameters<jet> p;
+  p.CME = 5020.0;
+  p.ptmin = 40.0;
+  p.ptmax = 1000.0;
+  p.ymin = -2.8;
+  p.ymax = +2.8;
+  p.opt.do_Qjet = true;
+  p.opt.do_Gjet = true;
+  histogram h(192, p.ptmin, p.ptmax);
+  p.ct18anlo.setct11("../incjet/i2TAn2.00.pds");
+  for (size_t i = 0; i < h.nbin; ++i) {
+    PROFILE_ZONE("bin");
+    Cuba::Result r = cubabin(p, h.low(i), h.high(i), o);
+    std::cout << "bin " << i << ": neval = " << r.neval
+              << ", fail = " << r.fail << std::endl;
+    h.set(i, r.integral[0], r.error[0]);
+  }
+  h.print(std::cout);
+  {
+    PROFILE_ZONE("output");
+    std::ofstream fout("results_cuba.txt", std::ios::out);
+    h.print(fout);
+  }
+  // display elapsed time
+  double elapsed = timer.elapsed();
+  std::cout << " Elapsed time: " << std::defaultfloat << elapsed
+            << " seconds" << std::endl;
+  // time per zone, with -DPROFILE; the zones inside the integrand are
+  // only counted here with ncores = 0, otherwise in the workers
+  Profile::report(std::cout);
+  return 0;
+}
@@ -0,0 +1,49 @@
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "cubacpp.h"
+
+// Volume of the n-sphere of radius rad with all four Cuba algorithms, the
+// C++ counterpart of main.f90. The integrand takes a batch of nvec points.
+int main(int argc, char* argv[]) {
+  // command line: ncores [nvec]
+  int ncores = (argc > 1) ? std::stoi(argv[1]) : 0;
+  int nvec = (argc > 2) ? std::stoi(argv[2]) : 64;
+  const int ndim = 3;
+  const double rad = 5.0;
+
+  // map [0, 1]^ndim to [-rad, rad]^ndim, jacobian (2 rad)^ndim
+  auto sphere = [&](const double* x, double* f, int n) {
+    double jacobian = std::pow(2.0 * rad, ndim);
+    for (int i = 0; i < n; ++i) {
+      double rsq = 0.0;
+      for (int k = 0; k < ndim; ++k) {
+        double dx = rad * (2.0 * x[i * ndim + k] - 1.0);
+        rsq += dx * dx;
+      }
+      f[i] = (rsq < rad * rad) ? jacobian : 0.0;
+    }
+  };
+
+  Cuba::cores(ncores);
+  cubaoptions o;
+  o.nvec = nvec;
+  o.mineval = 10000;
+  o.maxeval = 2000000;
+
+  double actual = std::pow(M_PI, ndim / 2.0) / std::tgamma(ndim / 2.0 + 1.0) *
+                  std::pow(rad, ndim);
+  auto print = [&](const char* name, const Cuba::Result& r) {
+    std::cout << std::setw(8) << name << "  integral = " << r.integral[0]
+              << " +- " << r.error[0] << "  neval = " << r.neval
+              << "  fail = " << r.fail << std::endl;
+  };
+  std::cout << std::setprecision(8) << "  actual    = " << actual << std::endl;
+  print("Vegas", Cuba::vegas(sphere, ndim, 1, o));
+  print("Suave", Cuba::suave(sphere, ndim, 1, o));
+  print("Divonne", Cuba::divonne(sphere, ndim, 1, o));
+  print("Cuhre", Cuba::cuhre(sphere, ndim, 1, o));
+  return 0;
+}
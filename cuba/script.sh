@@ -1 +1,4 @@
-gfortran -o test.exe main.f90 -lcuba
\ No newline at end of file
+gfortran -o test.exe main.f90 -lcuba
+g++ -O3 -o testcpp.exe main.cpp -lcuba -lm
+g++ -O3 -c ../incjet/ct11pdf.cc -o ct11pdf.o
+g++ -O3 -o incjet.exe incjet.cpp ct11pdf.o -lcuba -lgsl -lm
@@ -0,0 +1,96 @@
+! FFI benchmark: PDF values of all flavours at the same points, once with
+! one C call per flavour and point, and once with batched calls of nbatch
+! points. The difference is the cost of crossing the language boundary.
+! usage: bench.exe [pdsfile] [npoint]
+program bench
+  use iso_c_binding
+  use pdfapi
+  implicit none
+  type(c_ptr) :: h
+  character(len=256) :: pdsfile, arg
+  integer :: npoint, i, f, k, b, nb
+  integer, parameter :: nbatch(4) = [1, 16, 256, 4096]
+  real(c_double), allocatable :: x(:), q(:), pdf(:,:), as(:)
+  real(c_double) :: u(2), total
+  integer(8) :: t0, rate
+  integer, allocatable :: seed(:)
+
+  pdsfile = '../../incjet/i2TAn2.00.pds'
+  npoint = 100000
+  if(command_argument_count() >= 1) call get_command_argument(1, pdsfile)
+  if(command_argument_count() >= 2) then
+    call get_command_argument(2, arg);  read(arg,*) npoint
+  endif
+
+  h = pdf_load(pdsfile)
+  if(.not. c_associated(h)) then
+    write(*,'(a,a)') "Error: unable to read ", trim(pdsfile)
+    stop 1
+  endif
+
+  ! fixed random points: x log-uniform in [1e-5, 0.9], Q in [5, 1000] GeV
+  call random_seed(size=k)
+  allocate(seed(k))
+  seed = 20240101
+  call random_seed(put=seed)
+  allocate(x(npoint), q(npoint), pdf(-5:5,npoint), as(npoint))
+  do i = 1,npoint
+    call random_number(u)
+    x(i) = 1d-5 * (0.9d0/1d-5)**u(1)
+    q(i) = 5d0 * (1000d0/5d0)**u(2)
+  enddo
+
+  write(*,'(a,i0)') "api version: ", pdfapi_version()
+  write(*,'(a)') "call,batch,ns_per_value,checksum"
+
+  ! one crossing per flavour and point
+  call tic()
+  total = 0d0
+  do i = 1,npoint
+    do f = -5,5
+      total = total + pdfapi_parton(h, f, x(i), q(i))
+    enddo
+  enddo
+  call toc("parton", 1, 11*npoint, total)
+
+  ! one crossing per batch of points
+  do b = 1,size(nbatch)
+    call tic()
+    do i = 1,npoint,nbatch(b)
+      nb = min(nbatch(b), npoint-i+1)
+      ! element sequence association: pdf(-5,i) starts the nb columns
+      call pdfapi_partons(h, int(nb,c_size_t), x(i), q(i), pdf(-5,i))
+    enddo
+    call toc("partons", nbatch(b), 11*npoint, sum(pdf))
+  enddo
+
+  ! alpha_s, one and all points per crossing
+  call tic()
+  total = 0d0
+  do i = 1,npoint
+    total = total + pdfapi_alphas(h, q(i))
+  enddo
+  call toc("alphas", 1, npoint, total)
+  call tic()
+  call pdfapi_alphas_n(h, int(npoint,c_size_t), q, as)
+  call toc("alphas_n", npoint, npoint, sum(as))
+
+  call pdfapi_free(h)
+
+contains
+
+  subroutine tic()
+    call system_clock(t0, rate)
+  end subroutine tic
+
+  subroutine toc(name, batch, nvalue, checksum)
+    character(len=*), intent(in) :: name
+    integer, intent(in) :: batch, nvalue
+    real(c_double), intent(in) :: checksum
+    integer(8) :: t1
+    call system_clock(t1)
+    write(*,'(a,a,i0,a,f0.2,a,es22.15)') name, ",", batch, ",", &
+      1d9*dble(t1-t0)/dble(rate)/nvalue, ",", checksum
+  end subroutine toc
+
+end program bench
@@ -0,0 +1,13 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# C interface and Fortran benchmark; the PDF reader and the table come
+# from ../../incjet (run its fetch.sh first)
+INCJET=../../incjet
+
+g++ -O3 -Wall -Wextra -I"$INCJET" -c pdfapi.cpp -o pdfapi_c.o
+g++ -O3 -c "$INCJET/ct11pdf.cc" -o ct11pdf.o
+gfortran -O3 -Wall -c pdfapi.f90 -o pdfapi_f.o
+gfortran -O3 -Wall -o bench.exe bench.f90 pdfapi_f.o pdfapi_c.o ct11pdf.o -lstdc++
+
+echo "Run with ./bench.exe [pdsfile] [npoint]"
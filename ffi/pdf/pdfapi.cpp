@@ -0,0 +1,56 @@
+#include "pdfapi.h"
+
+#include <fstream>
+#include <new>
+#include <string>
+
+#include "ct11pdf.h"
+
+// the handle is the PDF itself
+struct pdfapi_handle {
+  cteqpdf pdf;
+};
+
+extern "C" {
+
+int pdfapi_version(void) { return PDFAPI_VERSION; }
+
+pdfapi_handle* pdfapi_load(const char* pdsfile) {
+  if (!pdsfile || !std::ifstream(pdsfile)) return nullptr;
+  auto* h = new (std::nothrow) pdfapi_handle;
+  if (!h) return nullptr;
+  // readct11, unlike setct11, does not exit the caller on a bad table
+  if (!h->pdf.readct11(pdsfile)) {
+    delete h;
+    return nullptr;
+  }
+  return h;
+}
+
+void pdfapi_free(pdfapi_handle* h) {
+  if (!h) return;
+  h->pdf.pdfexit();
+  delete h;
+}
+
+double pdfapi_parton(pdfapi_handle* h, int flavour, double x, double q) {
+  return h->pdf.parton(flavour, x, q);
+}
+
+double pdfapi_alphas(pdfapi_handle* h, double q) { return h->pdf.alphas(q); }
+
+void pdfapi_partons(pdfapi_handle* h, size_t n, const double* x,
+                    const double* q, double* pdf) {
+  for (size_t i = 0; i < n; ++i) {
+    double* out = pdf + PDFAPI_NFLAV * i;
+    for (int f = -5; f <= 5; ++f)
+      out[5 + f] = (x[i] < 1.0) ? h->pdf.parton(f, x[i], q[i]) : 0.0;
+  }
+}
+
+void pdfapi_alphas_n(pdfapi_handle* h, size_t n, const double* q,
+                     double* alphas) {
+  for (size_t i = 0; i < n; ++i) alphas[i] = h->pdf.alphas(q[i]);
+}
+
+}  // extern "C"
@@ -0,0 +1,72 @@
+! Fortran interface to pdfapi.h
+! The handle is a type(c_ptr); pdf_load takes a Fortran string.
+!   type(c_ptr) :: h
+!   h = pdf_load('i2TAn2.00.pds')
+!   call pdfapi_partons(h, int(n,c_size_t), x, q, pdf)   ! pdf(-5:5,n)
+!   call pdfapi_free(h)
+module pdfapi
+  use iso_c_binding
+  implicit none
+
+  integer, parameter :: pdfapi_nflav = 11
+
+  interface
+    function pdfapi_version() bind(C, name="pdfapi_version") result(res)
+      import :: c_int
+      integer(c_int) :: res
+    end function pdfapi_version
+
+    function pdfapi_load_c(pdsfile) bind(C, name="pdfapi_load") result(h)
+      import :: c_ptr, c_char
+      character(kind=c_char), dimension(*), intent(in) :: pdsfile
+      type(c_ptr) :: h
+    end function pdfapi_load_c
+
+    subroutine pdfapi_free(h) bind(C, name="pdfapi_free")
+      import :: c_ptr
+      type(c_ptr), value :: h
+    end subroutine pdfapi_free
+
+    function pdfapi_parton(h, flavour, x, q) bind(C, name="pdfapi_parton") &
+        result(res)
+      import :: c_ptr, c_int, c_double
+      type(c_ptr), value :: h
+      integer(c_int), value :: flavour
+      real(c_double), value :: x, q
+      real(c_double) :: res
+    end function pdfapi_parton
+
+    function pdfapi_alphas(h, q) bind(C, name="pdfapi_alphas") result(res)
+      import :: c_ptr, c_double
+      type(c_ptr), value :: h
+      real(c_double), value :: q
+      real(c_double) :: res
+    end function pdfapi_alphas
+
+    subroutine pdfapi_partons(h, n, x, q, pdf) bind(C, name="pdfapi_partons")
+      import :: c_ptr, c_size_t, c_double
+      type(c_ptr), value :: h
+      integer(c_size_t), value :: n
+      real(c_double), intent(in) :: x(n), q(n)
+      real(c_double), intent(out) :: pdf(11, n)
+    end subroutine pdfapi_partons
+
+    subroutine pdfapi_alphas_n(h, n, q, alphas) bind(C, name="pdfapi_alphas_n")
+      import :: c_ptr, c_size_t, c_double
+      type(c_ptr), value :: h
+      integer(c_size_t), value :: n
+      real(c_double), intent(in) :: q(n)
+      real(c_double), intent(out) :: alphas(n)
+    end subroutine pdfapi_alphas_n
+  end interface
+
+contains
+
+  ! load a .pds table, c_null_ptr if the file can not be read
+  function pdf_load(pdsfile) result(h)
+    character(len=*), intent(in) :: pdsfile
+    type(c_ptr) :: h
+    h = pdfapi_load_c(trim(pdsfile) // c_null_char)
+  end function pdf_load
+
+end module pdfapi
@@ -0,0 +1,50 @@
+#ifndef PDFAPI_H
+#define PDFAPI_H
+
+#include <stddef.h>
+
+/*
+ * C interface to the CTEQ PDF reader of incjet (cteqpdf), for C, Fortran
+ * and other FFI callers. A table is loaded into an opaque handle, which
+ * is passed to every call and released with pdfapi_free. Each handle has
+ * its own interpolation state, so threads need one handle each.
+ *
+ * Flavours are the CTEQ labels -5..5 (b_bar .. g .. b). The batched calls
+ * take arrays of n points and write all 11 flavours of point i to
+ * pdf[11*i + 5 + f], i.e. pdf(-5:5, n) in Fortran, which crosses the
+ * language boundary once per batch instead of once per flavour and point.
+ * x = 1 gives no number in cteqpdf; the batched calls return 0 there.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PDFAPI_VERSION 1
+#define PDFAPI_NFLAV 11
+
+typedef struct pdfapi_handle pdfapi_handle;
+
+/* version of this interface, PDFAPI_VERSION */
+int pdfapi_version(void);
+
+/* load a .pds table, NULL if the file can not be read or is malformed */
+pdfapi_handle* pdfapi_load(const char* pdsfile);
+void pdfapi_free(pdfapi_handle* h);
+
+/* one flavour at one point, and alpha_s at one scale */
+double pdfapi_parton(pdfapi_handle* h, int flavour, double x, double q);
+double pdfapi_alphas(pdfapi_handle* h, double q);
+
+/* all flavours at n points (x[i], q[i]), pdf[11*n] */
+void pdfapi_partons(pdfapi_handle* h, size_t n, const double* x,
+                    const double* q, double* pdf);
+/* alpha_s at n scales */
+void pdfapi_alphas_n(pdfapi_handle* h, size_t n, const double* q,
+                     double* alphas);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PDFAPI_H */
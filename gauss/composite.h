@@ -0,0 +1,139 @@
+#ifndef COMPOSITE_H
+#define COMPOSITE_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gaussleg.h"
+
+// Composite Gauss-Legendre integration on a thread pool, for integrands
+// that are expensive by themselves, e.g. a nested PDF convolution.
+// [a, b] is split into npanel equal panels, each integrated with the
+// N-point GaussLeg rule. Threads take panels one at a time, so uneven
+// panels balance out, and the panel results are added in panel order, so
+// the result is bit-identical for any number of threads.
+// The integrand is called from several threads at once, so it must not
+// modify shared state (cteqpdf does, give each thread its own copy).
+//
+// Nested use: a composite integral called from inside another one (e.g.
+// an inner integral in the integrand) runs serially on the calling thread,
+// so the pool is never oversubscribed. The same happens when the pool is
+// busy with a call from another thread.
+//
+// Usage:
+//   double r = Composite::integrate<16>(a, b, f, 64);  // 64 panels
+//   double s = Composite::integrate<16>(a, b, f, 64, 4);  // 4 threads
+class Composite {
+ public:
+  // nthread = 0 uses the whole pool, 1 runs serially
+  template <int N, typename Func>
+  static double integrate(double a, double b, Func&& f, size_t npanel,
+                          unsigned nthread = 0) {
+    std::vector<double> part(npanel, 0.0);
+    double h = (b - a) / static_cast<double>(npanel);
+    std::atomic<size_t> next{0};
+    auto job = [&]() {
+      for (size_t p; (p = next++) < npanel;) {
+        double lo = a + static_cast<double>(p) * h;
+        double hi = (p + 1 == npanel) ? b : a + static_cast<double>(p + 1) * h;
+        part[p] = GaussLeg::integrate<N>(lo, hi, f);
+      }
+    };
+    if (nthread == 0) nthread = pool().size();
+    if (nthread <= 1 || inside() || !pool().run(job, nthread)) job();
+    // deterministic reduction
+    double sum = 0.0;
+    for (double s : part) sum += s;
+    return sum;
+  }
+
+  // number of threads of the shared pool, including the calling thread
+  static unsigned threads() { return pool().size(); }
+
+ private:
+  // true on pool threads and on a caller while its job runs
+  static bool& inside() {
+    thread_local bool flag = false;
+    return flag;
+  }
+
+  // fixed set of worker threads, started at first use; a job runs on the
+  // caller and on nthread - 1 workers at the same time
+  class Pool {
+   public:
+    explicit Pool(unsigned nworker) {
+      for (unsigned i = 0; i < nworker; ++i)
+        workers.emplace_back([this, i] { loop(i); });
+    }
+    ~Pool() {
+      {
+        std::lock_guard<std::mutex> lk(m);
+        stop = true;
+      }
+      cv.notify_all();
+      for (auto& t : workers) t.join();
+    }
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // run job, false if the pool is busy with another caller
+    bool run(const std::function<void()>& job, unsigned nthread) {
+      std::unique_lock<std::mutex> busy(caller, std::try_to_lock);
+      if (!busy.owns_lock()) return false;
+      {
+        std::lock_guard<std::mutex> lk(m);
+        current = &job;
+        limit = std::min(nthread, size()) - 1;
+        pending = static_cast<unsigned>(workers.size());
+        ++generation;
+      }
+      cv.notify_all();
+      inside() = true;
+      job();
+      inside() = false;
+      std::unique_lock<std::mutex> lk(m);
+      done.wait(lk, [this] { return pending == 0; });
+      current = nullptr;
+      return true;
+    }
+
+   private:
+    std::vector<std::thread> workers;
+    std::mutex caller;  // one job at a time
+    std::mutex m;
+    std::condition_variable cv, done;
+    const std::function<void()>* current = nullptr;
+    unsigned limit = 0, pending = 0;
+    size_t generation = 0;
+    bool stop = false;
+
+    void loop(unsigned id) {
+      inside() = true;
+      size_t seen = 0;
+      while (true) {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [&] { return stop || generation != seen; });
+        if (stop) return;
+        seen = generation;
+        const std::function<void()>* job = current;
+        bool active = id < limit;
+        lk.unlock();
+        if (active) (*job)();
+        lk.lock();
+        if (--pending == 0) done.notify_one();
+      }
+    }
+  };
+
+  static Pool& pool() {
+    static Pool p(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return p;
+  }
+};
+
+#endif  // COMPOSITE_H
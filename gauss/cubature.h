@@ -0,0 +1,203 @@
+#ifndef CUBATURE_H
+#define CUBATURE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "gaussleg.h"
+
+// Multidimensional quadrature from the Gauss-Legendre rules of GaussLeg.
+// The nodes and weights are built once into flat arrays, node i being
+// x[i*dim .. i*dim+dim-1], and then reused for any number of integrands.
+//   tensor:  n^dim points, exact for degree 2n-1 in each variable
+//   smolyak: sparse combination of tensor products of 1D rules with 2l-1
+//            points (l = 1, 2, ...), exact for total degree 2*level+1
+//            with far fewer points than the full tensor product for dim > 2
+// The sum runs over fixed chunks of points on several threads, and the
+// chunk sums are added in chunk order, so the result does not depend on
+// the number of threads.
+//
+// Usage:
+//   auto c = Cubature::smolyak({0, 0, 0}, {1, 1, 1}, 5);
+//   double r = c.integrate([](const double* x) { return ...; });
+class Cubature {
+ public:
+  size_t dim() const { return d; }
+  size_t size() const { return w.size(); }
+  const double* node(size_t i) const { return &x[i * d]; }
+  double weight(size_t i) const { return w[i]; }
+
+  // full tensor product of n-point rules
+  static Cubature tensor(const std::vector<double>& lower,
+                         const std::vector<double>& upper, int n) {
+    size_t dim = lower.size();
+    std::vector<int> level(dim, n);
+    std::map<std::vector<double>, double> points;
+    add_tensor(level, 1.0, points, false);
+    return Cubature(lower, upper, points);
+  }
+
+  // Smolyak sparse grid of the given level (0 gives the 1-point rule)
+  static Cubature smolyak(const std::vector<double>& lower,
+                          const std::vector<double>& upper, int level) {
+    int dim = static_cast<int>(lower.size());
+    int q = dim + level;
+    std::map<std::vector<double>, double> points;
+    // all multi-indices i >= 1 with q - dim + 1 <= |i| <= q, and the
+    // combination coefficient (-1)^(q - |i|) * binomial(dim - 1, q - |i|)
+    std::vector<int> idx(dim, 1);
+    while (true) {
+      int norm = 0;
+      for (int k : idx) norm += k;
+      if (norm > q - dim && norm <= q) {
+        int m = q - norm;
+        double c = binomial(dim - 1, m) * ((m % 2 == 0) ? 1.0 : -1.0);
+        add_tensor(idx, c, points, true);
+      }
+      // next multi-index with |i| <= q
+      int k = 0;
+      while (k < dim) {
+        ++idx[k];
+        int sum = 0;
+        for (int j : idx) sum += j;
+        if (sum <= q) break;
+        idx[k] = 1;
+        ++k;
+      }
+      if (k == dim) break;
+    }
+    return Cubature(lower, upper, points);
+  }
+
+  // number of points of smolyak(lower, upper, level) in dim dimensions,
+  // counted without building the grid. The odd rules share only the node
+  // 0, so a point is fixed by choosing in each direction either 0 or one
+  // of the 2l-2 other nodes of the rule with 2l-1 points; it is on the
+  // grid if a multi-index of the combination has these rules (points
+  // whose weights cancel exactly are not subtracted).
+  static double smolyak_size(size_t dim, int level) {
+    int q = static_cast<int>(dim) + level;
+    // with[s], without[s]: choices so far with |l| = s, with and without
+    // a 0 (taken as l = 1), whose index can grow up to the shell of |i|
+    std::vector<double> with(q + 1, 0.0), without(q + 1, 0.0);
+    without[0] = 1.0;
+    for (size_t k = 0; k < dim; ++k) {
+      std::vector<double> w2(q + 1, 0.0), wo2(q + 1, 0.0);
+      for (int s = 0; s < q; ++s) {
+        w2[s + 1] += with[s] + without[s];
+        for (int l = 2; s + l <= q; ++l) {
+          w2[s + l] += with[s] * (2 * l - 2);
+          wo2[s + l] += without[s] * (2 * l - 2);
+        }
+      }
+      with.swap(w2);
+      without.swap(wo2);
+    }
+    double n = 0.0;
+    for (int s = 0; s <= q; ++s)
+      n += with[s] + (s > q - static_cast<int>(dim) ? without[s] : 0.0);
+    return n;
+  }
+
+  // integral of f(const double* x), nthread = 0 uses all hardware threads
+  template <typename Func>
+  double integrate(Func&& f, unsigned nthread = 0) const {
+    size_t nchunk = (size() + chunk - 1) / chunk;
+    std::vector<double> partial(nchunk, 0.0);
+    auto work = [&](size_t first, size_t stride) {
+      for (size_t c = first; c < nchunk; c += stride) {
+        size_t end = std::min(size(), (c + 1) * chunk);
+        double sum = 0.0;
+        for (size_t i = c * chunk; i < end; ++i) sum += w[i] * f(node(i));
+        partial[c] = sum;
+      }
+    };
+    if (nthread == 0)
+      nthread = std::max(1u, std::thread::hardware_concurrency());
+    size_t nt = std::min<size_t>(nthread, nchunk);
+    if (nt <= 1) {
+      work(0, 1);
+    } else {
+      std::vector<std::thread> pool;
+      for (size_t t = 0; t < nt; ++t) pool.emplace_back(work, t, nt);
+      for (auto& th : pool) th.join();
+    }
+    // deterministic reduction
+    double sum = 0.0;
+    for (double s : partial) sum += s;
+    return sum;
+  }
+
+ private:
+  static constexpr size_t chunk = 1024;  // points per chunk
+  size_t d = 0;
+  std::vector<double> x, w;
+
+  // flat arrays mapped from [-1, 1]^dim to [lower, upper]
+  Cubature(const std::vector<double>& lower, const std::vector<double>& upper,
+           const std::map<std::vector<double>, double>& points)
+      : d(lower.size()) {
+    double jac = 1.0;
+    for (size_t k = 0; k < d; ++k) jac *= 0.5 * (upper[k] - lower[k]);
+    x.reserve(points.size() * d);
+    w.reserve(points.size());
+    for (const auto& p : points) {
+      if (p.second == 0.0) continue;  // cancelled in the combination
+      for (size_t k = 0; k < d; ++k) {
+        double half = 0.5 * (upper[k] - lower[k]);
+        x.push_back(lower[k] + half * (1.0 + p.first[k]));
+      }
+      w.push_back(jac * p.second);
+    }
+  }
+
+  static double binomial(int n, int k) {
+    double b = 1.0;
+    for (int j = 1; j <= k; ++j) b = b * (n - k + j) / j;
+    return b;
+  }
+
+  // full n-point rule on [-1, 1], nodes in increasing order
+  static void rule1d(int n, std::vector<double>& xs, std::vector<double>& ws) {
+    int half = (n + 1) / 2;
+    xs.assign(n, 0.0);
+    ws.assign(n, 0.0);
+    for (int k = 0; k < half; ++k) {
+      double xk, wk;
+      GaussLeg::node(n, k, xk, wk);
+      xs[(n - 1) / 2 - k] = -xk;
+      ws[(n - 1) / 2 - k] = wk;
+      xs[n / 2 + k] = xk;
+      ws[n / 2 + k] = wk;
+    }
+  }
+
+  // add c times the tensor product of 1D rules, with idx[k] points in
+  // direction k, or 2*idx[k]-1 points for the Smolyak levels
+  static void add_tensor(const std::vector<int>& idx, double c,
+                         std::map<std::vector<double>, double>& points,
+                         bool levels) {
+    size_t dim = idx.size();
+    std::vector<std::vector<double>> xs(dim), ws(dim);
+    for (size_t k = 0; k < dim; ++k)
+      rule1d(levels ? 2 * idx[k] - 1 : idx[k], xs[k], ws[k]);
+    std::vector<size_t> j(dim, 0);
+    std::vector<double> pt(dim);
+    while (true) {
+      double wt = c;
+      for (size_t k = 0; k < dim; ++k) {
+        pt[k] = xs[k][j[k]];
+        wt *= ws[k][j[k]];
+      }
+      points[pt] += wt;
+      size_t k = 0;
+      while (k < dim && ++j[k] == xs[k].size()) j[k++] = 0;
+      if (k == dim) break;
+    }
+  }
+};
+
+#endif  // CUBATURE_H
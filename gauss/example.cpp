@@ -3,6 +3,7 @@
 #include <cmath>
 #include <iostream>
 
+#include "gausskronrod.h"
 #include "gaussleg.h"
 
 int main() {
@@ -24,6 +25,10 @@ int main() {
   double result16 = GaussLeg::integrate16(xmin, xmax, f);
   double result32 = GaussLeg::integrate32(xmin, xmax, f);
   double result64 = GaussLeg::integrate64(xmin, xmax, f);
+  // any other order, with nodes and weights generated at compile time
+  double result48 = GaussLeg::integrate<48>(xmin, xmax, f);
+  // adaptive G7-K15 with error estimate
+  auto adaptive = GaussKronrod<7>::integrate(xmin, xmax, f, 1e-10);
 
   // Output results
   std::cout << "4-point integration result: " << result4 << std::endl;
@@ -31,6 +36,10 @@ int main() {
   std::cout << "16-point integration result: " << result16 << std::endl;
   std::cout << "32-point integration result: " << result32 << std::endl;
   std::cout << "64-point integration result: " << result64 << std::endl;
+  std::cout << "48-point integration result: " << result48 << std::endl;
+  std::cout << "adaptive G7-K15 result: " << adaptive.value << " +- "
+            << adaptive.error << " (" << adaptive.neval << " evaluations)"
+            << std::endl;
   std::cout << "exact integral = " << exact << std::endl;
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,272 @@
+#ifndef GAUSSKRONROD_H
+#define GAUSSKRONROD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "gaussleg.h"
+
+// Adaptive Gauss-Kronrod integration with global subdivision.
+// The (2N+1)-point Kronrod rule adds N+1 nodes to the N-point Gauss rule
+// of GaussLeg, and the difference of the two gives the error estimate.
+// The interval with the largest error is always bisected next, until the
+// total error is below max(epsabs, epsrel * |value|) or the evaluation
+// budget is used up. N = 7 gives the classic G7-K15 pair of QUADPACK.
+//
+// Usage:
+//   auto r = GaussKronrod<>::integrate(a, b, f, 1e-10);
+//   r.value, r.error, r.neval
+template <int N = 7>
+class GaussKronrod {
+ public:
+  static constexpr int npoint = 2 * N + 1;
+
+  struct Result {
+    double value;  // integral estimate
+    double error;  // estimated absolute error
+    size_t neval;  // number of function evaluations
+  };
+
+  // positive half of the Kronrod rule, nodes in decreasing order, the last
+  // node is x = 0; the Gauss nodes are the odd entries (1, 3, ...) and wg
+  // holds their weights, with the x = 0 weight last when N is odd
+  struct Rule {
+    double xk[N + 1], wk[N + 1];
+    double wg[(N + 1) / 2];
+  };
+
+  // the rule is computed once, at first use
+  static const Rule& rule() {
+    static const Rule r = make_rule();
+    return r;
+  }
+
+  // one (2N+1)-point Kronrod rule on [a, b], no subdivision
+  template <typename Func>
+  static double integrate_rule(double a, double b, Func&& f, double& error) {
+    Segment s{a, b, 0.0, 0.0};
+    evaluate(s, f);
+    error = s.error;
+    return s.value;
+  }
+
+  // adaptive integration
+  template <typename Func>
+  static Result integrate(double a, double b, Func&& f, double epsrel = 1e-10,
+                          double epsabs = 0.0, size_t maxeval = 100000) {
+    std::priority_queue<Segment> heap;
+    Segment s{a, b, 0.0, 0.0};
+    evaluate(s, f);
+    heap.push(s);
+    size_t neval = npoint;
+    double value = s.value, error = s.error;
+    while (error > std::max(epsabs, epsrel * std::fabs(value)) &&
+           neval + 2 * npoint <= maxeval) {
+      Segment worst = heap.top();
+      double mid = 0.5 * (worst.a + worst.b);
+      // can not be split any further
+      if (!(worst.a < mid && mid < worst.b)) break;
+      heap.pop();
+      Segment left{worst.a, mid, 0.0, 0.0}, right{mid, worst.b, 0.0, 0.0};
+      evaluate(left, f);
+      evaluate(right, f);
+      neval += 2 * npoint;
+      value += left.value + right.value - worst.value;
+      error += left.error + right.error - worst.error;
+      heap.push(left);
+      heap.push(right);
+    }
+    // final sums over all intervals, free of the running update round-off
+    value = error = 0.0;
+    for (; !heap.empty(); heap.pop()) {
+      value += heap.top().value;
+      error += heap.top().error;
+    }
+    return {value, error, neval};
+  }
+
+ private:
+  struct Segment {
+    double a, b;
+    double value, error;
+    bool operator<(const Segment& o) const { return error < o.error; }
+  };
+
+  // Kronrod and Gauss sums on one interval, QUADPACK error estimate
+  template <typename Func>
+  static void evaluate(Segment& s, Func& f) {
+    const Rule& r = rule();
+    constexpr double eps = std::numeric_limits<double>::epsilon();
+    constexpr double tiny = std::numeric_limits<double>::min();
+    double center = 0.5 * (s.a + s.b);
+    double half = 0.5 * (s.b - s.a);
+    double f1[N], f2[N];
+    double fc = f(center);
+    double resk = fc * r.wk[N];
+    double resg = (N % 2 == 1) ? fc * r.wg[N / 2] : 0.0;
+    double resabs = std::fabs(resk);
+    for (int j = 0; j < N; ++j) {
+      double dx = half * r.xk[j];
+      f1[j] = f(center - dx);
+      f2[j] = f(center + dx);
+      double fsum = f1[j] + f2[j];
+      resk += r.wk[j] * fsum;
+      resabs += r.wk[j] * (std::fabs(f1[j]) + std::fabs(f2[j]));
+      if (j % 2 == 1) resg += r.wg[j / 2] * fsum;
+    }
+    double reskh = 0.5 * resk;
+    double resasc = r.wk[N] * std::fabs(fc - reskh);
+    for (int j = 0; j < N; ++j)
+      resasc += r.wk[j] * (std::fabs(f1[j] - reskh) + std::fabs(f2[j] - reskh));
+    double habs = std::fabs(half);
+    s.value = resk * half;
+    resabs *= habs;
+    resasc *= habs;
+    double err = std::fabs((resk - resg) * half);
+    if (resasc != 0.0 && err != 0.0)
+      err = resasc * std::min(1.0, std::pow(200.0 * err / resasc, 1.5));
+    if (resabs > tiny / (50.0 * eps)) err = std::max(50.0 * eps * resabs, err);
+    s.error = err;
+  }
+
+  // Legendre polynomials P_0 .. P_n at x
+  static void legendre_all(int n, long double x, long double* p) {
+    p[0] = 1.0L;
+    if (n > 0) p[1] = x;
+    for (int j = 2; j <= n; ++j)
+      p[j] = ((2 * j - 1) * x * p[j - 1] - (j - 1) * p[j - 2]) / j;
+  }
+
+  // solve A c = y in place, Gaussian elimination with partial pivoting
+  static void solve(std::vector<std::vector<long double>>& A,
+                    std::vector<long double>& y) {
+    int n = static_cast<int>(y.size());
+    for (int c = 0; c < n; ++c) {
+      int piv = c;
+      for (int r = c + 1; r < n; ++r)
+        if (std::fabs(A[r][c]) > std::fabs(A[piv][c])) piv = r;
+      std::swap(A[c], A[piv]);
+      std::swap(y[c], y[piv]);
+      for (int r = c + 1; r < n; ++r) {
+        long double m = A[r][c] / A[c][c];
+        for (int k = c; k < n; ++k) A[r][k] -= m * A[c][k];
+        y[r] -= m * y[c];
+      }
+    }
+    for (int c = n - 1; c >= 0; --c) {
+      for (int k = c + 1; k < n; ++k) y[c] -= A[c][k] * y[k];
+      y[c] /= A[c][c];
+    }
+  }
+
+  // Kronrod extension of the N-point Gauss rule:
+  // 1. the new nodes are the roots of the Stieltjes polynomial
+  //    E(x) = P_{N+1} + sum_j c_j P_j (same parity), fixed by
+  //    int P_N(x) P_k(x) E(x) dx = 0 for k <= N; the integrals are exact
+  //    with a Gauss rule of 2N+2 points
+  // 2. they interlace with the Gauss nodes, so each is found by bisection
+  // 3. all weights from the exactness for P_0 .. P_{3N+1}, even ones only
+  static Rule make_rule() {
+    // Gauss nodes, decreasing, and a high-order Gauss rule for the moments
+    std::vector<long double> xg(N);
+    std::vector<double> wgauss(N);
+    for (int k = 0; k < (N + 1) / 2; ++k) {
+      double x, w;
+      GaussLeg::node(N, k, x, w);
+      xg[N / 2 - 1 - k + (N % 2)] = x;  // positive half, decreasing
+      xg[N / 2 + k] = -x;
+      wgauss[N / 2 - 1 - k + (N % 2)] = w;
+    }
+    // the negative nodes of the moment rule follow from parity
+    const int M = 2 * N + 2;
+    std::vector<long double> xm, wm;
+    for (int k = 0; k < (M + 1) / 2; ++k) {
+      double x, w;
+      GaussLeg::node(M, k, x, w);
+      xm.push_back(x);
+      wm.push_back(w);
+      if (x != 0.0) {
+        xm.push_back(-x);
+        wm.push_back(w);
+      }
+    }
+    // 1. Stieltjes polynomial coefficients: unknown c_j for
+    //    j = N-1, N-3, ... >= 0; conditions for odd k, the even ones
+    //    vanish by parity
+    std::vector<int> js, ks;
+    for (int j = N - 1; j >= 0; j -= 2) js.push_back(j);
+    for (int k = 1; k <= N; k += 2) ks.push_back(k);
+    int m = static_cast<int>(js.size());
+    std::vector<std::vector<long double>> A(m, std::vector<long double>(m));
+    std::vector<long double> y(m, 0.0L);
+    std::vector<long double> p(N + 2);
+    for (size_t q = 0; q < xm.size(); ++q) {
+      legendre_all(N + 1, xm[q], p.data());
+      for (int r = 0; r < m; ++r) {
+        long double base = wm[q] * p[N] * p[ks[r]];
+        for (int c = 0; c < m; ++c) A[r][c] += base * p[js[c]];
+        y[r] -= base * p[N + 1];
+      }
+    }
+    solve(A, y);
+    auto stieltjes = [&](long double x) {
+      std::vector<long double> pp(N + 2);
+      legendre_all(N + 1, x, pp.data());
+      long double e = pp[N + 1];
+      for (int c = 0; c < m; ++c) e += y[c] * pp[js[c]];
+      return e;
+    };
+    // 2. roots between successive Gauss nodes, decreasing
+    std::vector<long double> xs;
+    for (int k = 0; k <= N; ++k) {
+      long double hi = (k == 0) ? 1.0L : xg[k - 1];
+      long double lo = (k == N) ? -1.0L : xg[k];
+      long double fhi = stieltjes(hi);
+      for (int it = 0; it < 200; ++it) {
+        long double mid = 0.5L * (lo + hi);
+        if (mid <= lo || mid >= hi) break;
+        long double fm = stieltjes(mid);
+        if ((fm > 0) == (fhi > 0)) {
+          hi = mid;
+          fhi = fm;
+        } else {
+          lo = mid;
+        }
+      }
+      xs.push_back(0.5L * (lo + hi));
+    }
+    // positive half, decreasing: Kronrod node, Gauss node, Kronrod node, ...
+    Rule r{};
+    std::vector<long double> xk(N + 1);
+    for (int j = 0; j <= N; ++j) {
+      long double x = (j % 2 == 0) ? xs[j / 2] : xg[j / 2];
+      xk[j] = (j == N) ? 0.0L : x;
+    }
+    // 3. weights, the node x = 0 counts once and the others twice
+    int n = N + 1;
+    std::vector<std::vector<long double>> B(n, std::vector<long double>(n));
+    std::vector<long double> mom(n, 0.0L);
+    std::vector<long double> pk(2 * N + 1);
+    for (int c = 0; c < n; ++c) {
+      legendre_all(2 * N, xk[c], pk.data());
+      for (int e = 0; e < n; ++e)
+        B[e][c] = (c == N ? 1.0L : 2.0L) * pk[2 * e];
+    }
+    mom[0] = 2.0L;
+    solve(B, mom);
+    for (int j = 0; j <= N; ++j) {
+      r.xk[j] = static_cast<double>(xk[j]);
+      r.wk[j] = static_cast<double>(mom[j]);
+    }
+    // Gauss weights of the odd entries, x = 0 last for odd N
+    for (int j = 0; j < (N + 1) / 2; ++j) r.wg[j] = wgauss[j];
+    return r;
+  }
+};
+
+#endif  // GAUSSKRONROD_H
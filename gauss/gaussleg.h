@@ -2,151 +2,198 @@
 #define GAUSSLEG_H
 
 #include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+// Gauss-Legendre rules of any order N, generated at compile time.
+// The nodes are the roots of the Legendre polynomial P_N, found by Newton
+// iteration from the asymptotic guess cos(pi (i - 1/4) / (N + 1/2)), and
+// the weights are w = 2 / ((1 - x^2) P_N'(x)^2). Everything is evaluated in
+// long double, so the tables are correct to the last bit of a double.
 class GaussLeg {
- private:
-  // 4-point nodes and weights
-  static constexpr std::array<double, 2> x4 = {0.3399810435848563,
-                                               0.8611363115940526};
-
-  static constexpr std::array<double, 2> w4 = {0.6521451548625461,
-                                               0.3478548451374538};
-
-  // 8-point nodes and weights
-  static constexpr std::array<double, 4> x8 = {
-      0.1834346424956498, 0.5255324099163290, 0.7966664774136267,
-      0.9602898564975363};
-  static constexpr std::array<double, 4> w8 = {
-      0.3626837833783620, 0.3137066458778873, 0.2223810344533745,
-      0.1012285362903763};
-
-  // 16-point nodes and weights
-  static constexpr std::array<double, 8> x16 = {
-      0.0950125098376374, 0.2816035507792589, 0.4580167776572274,
-      0.6178762444026438, 0.7554044083550030, 0.8656312023878318,
-      0.9445750230732326, 0.9894009349916499};
-  static constexpr std::array<double, 8> w16 = {
-      0.1894506104550685, 0.1826034150449236, 0.1691565193950025,
-      0.1495959888165767, 0.1246289712555339, 0.0951585116824928,
-      0.0622535239386479, 0.0271524594117541};
-
-  // 32-point nodes and weights
-  static constexpr std::array<double, 16> x32 = {
-      0.0483076656877383, 0.1444719615827965, 0.2392873622521371,
-      0.3318686022821277, 0.4213512761306353, 0.5068999089322294,
-      0.5877157572407623, 0.6630442669302152, 0.7321821187402897,
-      0.7944837959679424, 0.8493676137325700, 0.8963211557660521,
-      0.9349060759377397, 0.9647622555875064, 0.9856115115452684,
-      0.9972638618494816};
-  static constexpr std::array<double, 16> w32 = {
-      0.0965400885147278, 0.0956387200792749, 0.0938443990808046,
-      0.0911738786957639, 0.0876520930044038, 0.0833119242269467,
-      0.0781938957870703, 0.0723457941088485, 0.0658222227763618,
-      0.0586840934785355, 0.0509980592623762, 0.0428358980222267,
-      0.0342738629130214, 0.0253920653092621, 0.0162743947309057,
-      0.0070186100094701};
-
-  // 64-point nodes and weights
-  static constexpr std::array<double, 32> x64 = {
-      0.0243502926634244, 0.0729931217877990, 0.1214628192961206,
-      0.1696444204239928, 0.2174236437400071, 0.2646871622087674,
-      0.3113228719902110, 0.3572201583376681, 0.4022701579639916,
-      0.4463660172534641, 0.4894031457070530, 0.5312794640198946,
-      0.5718956462026340, 0.6111553551723933, 0.6489654712546573,
-      0.6852363130542333, 0.7198818501716109, 0.7528199072605319,
-      0.7839723589433414, 0.8132653151227975, 0.8406292962525803,
-      0.8659993981540928, 0.8893154459951141, 0.9105221370785028,
-      0.9295691721319396, 0.9464113748584028, 0.9610087996520538,
-      0.9733268277899110, 0.9833362538846260, 0.9910133714767443,
-      0.9963401167719553, 0.9993050417357722};
-  static constexpr std::array<double, 32> w64 = {
-      0.0486909570091397, 0.0485754674415034, 0.0483447622348030,
-      0.0479993885964583, 0.0475401657148303, 0.0469681828162100,
-      0.0462847965813144, 0.0454916279274181, 0.0445905581637566,
-      0.0435837245293235, 0.0424735151236536, 0.0412625632426235,
-      0.0399537411327203, 0.0385501531786156, 0.0370551285402400,
-      0.0354722132568824, 0.0338051618371416, 0.0320579283548516,
-      0.0302346570724025, 0.0283396726142595, 0.0263774697150547,
-      0.0243527025687109, 0.0222701738083833, 0.0201348231535302,
-      0.0179517157756973, 0.0157260304760247, 0.0134630478967186,
-      0.0111681394601311, 0.0088467598263639, 0.0065044579689784,
-      0.0041470332605625, 0.0017832807216964};
-
  public:
-  // 4-point integration
-  template <typename Func>
-  static double integrate4(double a, double b, Func&& f) {
-    constexpr int half_n = 2;
-    double d_half = (b - a) / 2.0;
-    double sum = 0.0;
-    for (int i = 0; i < half_n; ++i) {
-      double z1 = a + d_half * (1.0 - x4[i]);
-      double z2 = a + d_half * (1.0 + x4[i]);
-      double w_scaled = d_half * w4[i];
-      sum += w_scaled * f(z1) + w_scaled * f(z2);
+  // positive half of an N-point rule, nodes in increasing order
+  // for odd N the first node is x = 0
+  template <int N>
+  struct Rule {
+    static constexpr int half_n = (N + 1) / 2;
+    std::array<double, half_n> x{}, w{};
+  };
+
+  // k-th positive node (k = 0 is the smallest) and weight of the n-point
+  // rule, usable both at compile time and at run time
+  static constexpr void node(int n, int k, double& x, double& w) {
+    // root index from the largest: i = 1 is the node closest to x = 1
+    int i = (n + 1) / 2 - k;
+    long double z = cosine(pi * (i - 0.25L) / (n + 0.5L));
+    long double dp = 0.0L;
+    for (int it = 0; it < 100; ++it) {
+      long double p = 0.0L;
+      legendre(n, z, p, dp);
+      long double dz = p / dp;
+      z -= dz;
+      if (absl(dz) <= 1e-19L) break;
     }
-    return sum;
+    long double p = 0.0L;
+    legendre(n, z, p, dp);
+    x = static_cast<double>(z);
+    w = static_cast<double>(2.0L / ((1.0L - z * z) * dp * dp));
+    if (n % 2 == 1 && k == 0) x = 0.0;  // exact middle node
   }
 
-  // 8-point integration
-  template <typename Func>
-  static double integrate8(double a, double b, Func&& f) {
-    constexpr int half_n = 4;
+  // the whole positive half of the N-point rule
+  template <int N>
+  static constexpr Rule<N> make_rule() {
+    static_assert(N >= 1, "at least one node");
+    Rule<N> r;
+    for (int k = 0; k < Rule<N>::half_n; ++k) node(N, k, r.x[k], r.w[k]);
+    return r;
+  }
+
+  // compile-time tables, one per order in use
+  template <int N>
+  static constexpr Rule<N> rule = make_rule<N>();
+
+  // N-point integration, the loop over nodes is unrolled at compile time
+  // f returns either a double, or a std::array<double, M> of M related
+  // functions, which are then integrated in one sweep over the nodes
+  template <int N, typename Func>
+  static auto integrate(double a, double b, Func&& f) {
+    using R = std::decay_t<decltype(f(a))>;
     double d_half = (b - a) / 2.0;
-    double sum = 0.0;
-    for (int i = 0; i < half_n; ++i) {
-      double z1 = a + d_half * (1.0 - x8[i]);
-      double z2 = a + d_half * (1.0 + x8[i]);
-      double w_scaled = d_half * w8[i];
-      sum += w_scaled * f(z1) + w_scaled * f(z2);
+    if constexpr (std::is_arithmetic_v<R>) {
+      double mid = (N % 2 == 1) ? d_half * rule<N>.w[0] * f(a + d_half) : 0.0;
+      return sum<N>(a, d_half, f, std::make_index_sequence<N / 2>{}) + mid;
+    } else {
+      R res{};
+      for (int k = N % 2; k < Rule<N>::half_n; ++k) {
+        R f1 = f(a + d_half * (1.0 - rule<N>.x[k]));
+        R f2 = f(a + d_half * (1.0 + rule<N>.x[k]));
+        double w_scaled = d_half * rule<N>.w[k];
+        for (size_t m = 0; m < res.size(); ++m)
+          res[m] += w_scaled * f1[m] + w_scaled * f2[m];
+      }
+      if (N % 2 == 1) {
+        R fm = f(a + d_half);
+        for (size_t m = 0; m < res.size(); ++m)
+          res[m] += d_half * rule<N>.w[0] * fm[m];
+      }
+      return res;
     }
-    return sum;
   }
 
-  // 16-point integration
-  template <typename Func>
-  static double integrate16(double a, double b, Func&& f) {
-    constexpr int half_n = 8;
+  // m functions of run-time number: f(x, values) fills values[m], and the
+  // integrals are written to out[m]
+  template <int N, typename Func>
+  static void integrate(double a, double b, Func&& f, double* out, size_t m) {
+    std::vector<double> f1(m), f2(m);
     double d_half = (b - a) / 2.0;
-    double sum = 0.0;
-    for (int i = 0; i < half_n; ++i) {
-      double z1 = a + d_half * (1.0 - x16[i]);
-      double z2 = a + d_half * (1.0 + x16[i]);
-      double w_scaled = d_half * w16[i];
-      sum += w_scaled * f(z1) + w_scaled * f(z2);
+    for (size_t j = 0; j < m; ++j) out[j] = 0.0;
+    for (int k = N % 2; k < Rule<N>::half_n; ++k) {
+      f(a + d_half * (1.0 - rule<N>.x[k]), f1.data());
+      f(a + d_half * (1.0 + rule<N>.x[k]), f2.data());
+      double w_scaled = d_half * rule<N>.w[k];
+      for (size_t j = 0; j < m; ++j) out[j] += w_scaled * f1[j] + w_scaled * f2[j];
+    }
+    if (N % 2 == 1) {
+      f(a + d_half, f1.data());
+      for (size_t j = 0; j < m; ++j) out[j] += d_half * rule<N>.w[0] * f1[j];
     }
-    return sum;
   }
 
-  // 32-point integration
-  template <typename Func>
-  static double integrate32(double a, double b, Func&& f) {
-    constexpr int half_n = 16;
+  // batched integration: f(x, fx, n) gets all n = N nodes in one call and
+  // fills fx[n], so it can vectorize and share its setup between nodes
+  template <int N, typename Func>
+  static double integrate_batch(double a, double b, Func&& f) {
+    constexpr int half_n = Rule<N>::half_n;
     double d_half = (b - a) / 2.0;
+    // symmetric pairs first, then the middle node of odd rules
+    std::array<double, N> x, fx;
+    int n = 0;
+    for (int k = N % 2; k < half_n; ++k) {
+      x[n++] = a + d_half * (1.0 - rule<N>.x[k]);
+      x[n++] = a + d_half * (1.0 + rule<N>.x[k]);
+    }
+    if (N % 2 == 1) x[n++] = a + d_half;
+    f(static_cast<const double*>(x.data()), fx.data(), static_cast<size_t>(N));
     double sum = 0.0;
-    for (int i = 0; i < half_n; ++i) {
-      double z1 = a + d_half * (1.0 - x32[i]);
-      double z2 = a + d_half * (1.0 + x32[i]);
-      double w_scaled = d_half * w32[i];
-      sum += w_scaled * f(z1) + w_scaled * f(z2);
+    n = 0;
+    for (int k = N % 2; k < half_n; ++k, n += 2) {
+      double w_scaled = d_half * rule<N>.w[k];
+      sum += w_scaled * fx[n] + w_scaled * fx[n + 1];
     }
+    if (N % 2 == 1) sum += d_half * rule<N>.w[0] * fx[n];
     return sum;
   }
 
-  // 64-point integration
+  // fixed orders
+  template <typename Func>
+  static double integrate4(double a, double b, Func&& f) {
+    return integrate<4>(a, b, f);
+  }
+  template <typename Func>
+  static double integrate8(double a, double b, Func&& f) {
+    return integrate<8>(a, b, f);
+  }
+  template <typename Func>
+  static double integrate16(double a, double b, Func&& f) {
+    return integrate<16>(a, b, f);
+  }
+  template <typename Func>
+  static double integrate32(double a, double b, Func&& f) {
+    return integrate<32>(a, b, f);
+  }
   template <typename Func>
   static double integrate64(double a, double b, Func&& f) {
-    constexpr int half_n = 32;
-    double d_half = (b - a) / 2.0;
-    double sum = 0.0;
-    for (int i = 0; i < half_n; ++i) {
-      double z1 = a + d_half * (1.0 - x64[i]);
-      double z2 = a + d_half * (1.0 + x64[i]);
-      double w_scaled = d_half * w64[i];
-      sum += w_scaled * f(z1) + w_scaled * f(z2);
+    return integrate<64>(a, b, f);
+  }
+
+ private:
+  static constexpr long double pi = 3.141592653589793238462643383279502884L;
+
+  static constexpr long double absl(long double x) { return x < 0 ? -x : x; }
+
+  // cos(x) for 0 <= x <= pi, only used for the initial guess
+  static constexpr long double cosine(long double x) {
+    long double term = 1.0L, sum = 1.0L;
+    for (int k = 1; k < 30; ++k) {
+      term *= -x * x / ((2 * k - 1) * (2 * k));
+      sum += term;
     }
     return sum;
   }
+
+  // P_n(x) and P_n'(x) from the three-term recurrence
+  static constexpr void legendre(int n, long double x, long double& p,
+                                 long double& dp) {
+    long double p0 = 1.0L, p1 = x;
+    for (int j = 2; j <= n; ++j) {
+      long double p2 = ((2 * j - 1) * x * p1 - (j - 1) * p0) / j;
+      p0 = p1;
+      p1 = p2;
+    }
+    p = p1;
+    dp = n * (x * p1 - p0) / (x * x - 1.0L);
+  }
+
+  // one pair of symmetric nodes, the middle node of odd rules is skipped
+  template <int N, size_t I, typename Func>
+  static double pair(double a, double d_half, Func& f) {
+    constexpr size_t k = N % 2 + I;
+    double z1 = a + d_half * (1.0 - rule<N>.x[k]);
+    double z2 = a + d_half * (1.0 + rule<N>.x[k]);
+    double w_scaled = d_half * rule<N>.w[k];
+    return w_scaled * f(z1) + w_scaled * f(z2);
+  }
+
+  // sum over all pairs, in the same order as a loop over the half rule
+  template <int N, typename Func, size_t... I>
+  static double sum([[maybe_unused]] double a, [[maybe_unused]] double d_half,
+                    [[maybe_unused]] Func& f, std::index_sequence<I...>) {
+    return (0.0 + ... + pair<N, I>(a, d_half, f));
+  }
 };
 
-#endif  // GAUSSLEG_H
\ No newline at end of file
+#endif  // GAUSSLEG_H
@@ -0,0 +1,251 @@
+#ifndef OSCILLATORY_H
+#define OSCILLATORY_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "gaussleg.h"
+
+// Integrals of oscillatory functions, where a plain GaussLeg rule needs
+// more than n/2 oscillations per interval.
+//
+//   bessel(f, nu, k):          int_0^inf f(x) J_nu(k x) dx
+//     integrates panel by panel between the zeros of J_nu(k x) and
+//     extrapolates the (alternating) partial sums with the Wynn epsilon
+//     algorithm; f should be smooth and non-oscillating
+//   levin_trig(f, a, b, w):    int_a^b f(x) {cos(w x), sin(w x)} dx
+//   levin_bessel(f, a, b, nu, w):  int_a^b f(x) J_nu(w x) dx,  a > 0
+//     Levin collocation: find p(x) with (p . w)' = f w_1 for the kernel
+//     vector w (w' = A w), then the integral is p . w at the end points;
+//     the cost does not grow with the frequency
+//
+// Usage:
+//   auto r = Oscillatory::bessel([](double x) { return 1.0 / (1 + x); }, 0, 1);
+//   r.value, r.error, r.neval
+class Oscillatory {
+ public:
+  struct Result {
+    double value;  // integral estimate
+    double error;  // estimated absolute error
+    size_t neval;  // number of function evaluations
+  };
+
+  // m-th positive zero of J_nu (m = 1, 2, ...), McMahon's asymptotic
+  // expansion refined by Newton iteration; good for moderate nu
+  static double bessel_zero(double nu, int m) {
+    double mu = 4.0 * nu * nu;
+    double beta = (m + 0.5 * nu - 0.25) * M_PI;
+    double b8 = 8.0 * beta;
+    double x = beta - (mu - 1.0) / b8 -
+               4.0 * (mu - 1.0) * (7.0 * mu - 31.0) / (3.0 * b8 * b8 * b8);
+    for (int it = 0; it < 50; ++it) {
+      double j = std::cyl_bessel_j(nu, x);
+      double dj = nu / x * j - std::cyl_bessel_j(nu + 1.0, x);
+      double dx = j / dj;
+      x -= dx;
+      if (std::fabs(dx) <= 1e-15 * x) break;
+    }
+    return x;
+  }
+
+  // Wynn epsilon extrapolation of the partial sums s, with the change of
+  // the estimate to the previous one as error
+  static double wynn(const std::vector<double>& s, double& error) {
+    size_t n = s.size();
+    if (n < 3) {
+      error = (n == 2) ? std::fabs(s[1] - s[0]) : 0.0;
+      return s.back();
+    }
+    // e[k][i] = epsilon_k^(i); only the even columns approximate the limit
+    std::vector<double> prev(n + 1, 0.0), cur(s.begin(), s.end());
+    double best = s.back(), last = s[n - 2];
+    for (size_t k = 1; cur.size() > 1; ++k) {
+      std::vector<double> next(cur.size() - 1);
+      for (size_t i = 0; i + 1 < cur.size(); ++i) {
+        double diff = cur[i + 1] - cur[i];
+        if (diff == 0.0) {
+          // converged exactly
+          error = 0.0;
+          return (k % 2 == 1) ? cur[i + 1] : best;
+        }
+        next[i] = prev[i + 1] + 1.0 / diff;
+      }
+      prev = std::move(cur);
+      cur = std::move(next);
+      if (k % 2 == 0) {
+        // the two newest entries of this even column
+        last = (cur.size() > 1) ? cur[cur.size() - 2] : best;
+        best = cur.back();
+      }
+    }
+    error = std::fabs(best - last);
+    return best;
+  }
+
+  // int_0^inf f(x) J_nu(k x) dx, with N-point Gauss-Legendre per panel
+  template <int N = 16, typename Func>
+  static Result bessel(Func&& f, double nu, double k, double epsrel = 1e-10,
+                       double epsabs = 0.0, int maxpanel = 200) {
+    auto g = [&](double x) { return f(x) * std::cyl_bessel_j(nu, k * x); };
+    std::vector<double> sums;
+    double a = 0.0, total = 0.0, value = 0.0, error = 0.0;
+    int nconv = 0;
+    for (int m = 1; m <= maxpanel; ++m) {
+      double b = bessel_zero(nu, m) / k;
+      total += GaussLeg::integrate<N>(a, b, g);
+      sums.push_back(total);
+      a = b;
+      value = wynn(sums, error);
+      // require two converged estimates in a row
+      if (m > 4 && error <= std::max(epsabs, epsrel * std::fabs(value))) {
+        if (++nconv == 2) break;
+      } else {
+        nconv = 0;
+      }
+    }
+    return {value, error, sums.size() * N};
+  }
+
+  // int_a^b f(x) cos(w x) dx and int_a^b f(x) sin(w x) dx with n
+  // collocation points; w = (cos, sin) obeys w' = [[0, -w], [w, 0]] w
+  template <typename Func>
+  static std::array<double, 2> levin_trig(Func&& f, double a, double b,
+                                          double omega, int n = 24) {
+    auto A = [omega](double, double* m) {
+      m[0] = 0.0;
+      m[1] = -omega;
+      m[2] = omega;
+      m[3] = 0.0;
+    };
+    auto w = [omega](double x, double* v) {
+      v[0] = std::cos(omega * x);
+      v[1] = std::sin(omega * x);
+    };
+    return levin(f, a, b, n, A, w);
+  }
+
+  // int_a^b f(x) J_nu(w x) dx for a > 0 with n collocation points;
+  // w = (J_nu, J_nu+1) obeys w' = [[nu/x, -w], [w, -(nu+1)/x]] w
+  template <typename Func>
+  static double levin_bessel(Func&& f, double a, double b, double nu,
+                             double omega, int n = 24) {
+    auto A = [nu, omega](double x, double* m) {
+      m[0] = nu / x;
+      m[1] = -omega;
+      m[2] = omega;
+      m[3] = -(nu + 1.0) / x;
+    };
+    auto w = [nu, omega](double x, double* v) {
+      v[0] = std::cyl_bessel_j(nu, omega * x);
+      v[1] = std::cyl_bessel_j(nu + 1.0, omega * x);
+    };
+    return levin(f, a, b, n, A, w)[0];
+  }
+
+ private:
+  // Levin collocation for a 2-component kernel w' = A w: p is expanded in
+  // Chebyshev polynomials and p' + A^T p = (f, 0) resp. (0, f) is imposed at
+  // the Chebyshev-Lobatto points; the integrals of f w_1 and f w_2 are
+  // p . w at b minus p . w at a
+  template <typename Func, typename Amat, typename Kernel>
+  static std::array<double, 2> levin(Func& f, double a, double b, int n,
+                                     Amat&& A, Kernel&& w) {
+    int dim = 2 * n;
+    double scale = 2.0 / (b - a);
+    std::vector<double> M(static_cast<size_t>(dim) * dim, 0.0);
+    std::vector<double> rhs1(dim, 0.0), rhs2(dim, 0.0);
+    std::vector<double> T(n), dT(n);
+    for (int i = 0; i < n; ++i) {
+      double t = -std::cos(M_PI * i / (n - 1));
+      double x = 0.5 * (a + b) + 0.5 * (b - a) * t;
+      chebyshev(n, t, T.data(), dT.data());
+      double m[4];
+      A(x, m);
+      // rows 2i and 2i+1: components 1 and 2 of p' + A^T p
+      double* r1 = &M[static_cast<size_t>(2 * i) * dim];
+      double* r2 = &M[static_cast<size_t>(2 * i + 1) * dim];
+      for (int j = 0; j < n; ++j) {
+        // unknowns: coefficients of p1 in 0..n-1, of p2 in n..2n-1
+        r1[j] = scale * dT[j] + m[0] * T[j];
+        r1[n + j] = m[2] * T[j];
+        r2[j] = m[1] * T[j];
+        r2[n + j] = scale * dT[j] + m[3] * T[j];
+      }
+      double fx = f(x);
+      rhs1[2 * i] = fx;
+      rhs2[2 * i + 1] = fx;
+    }
+    solve(M, dim, rhs1, rhs2);
+    // p . w at both ends, T_j(1) = 1 and T_j(-1) = (-1)^j
+    std::array<double, 2> res;
+    double wa[2], wb[2];
+    w(a, wa);
+    w(b, wb);
+    const std::vector<double>* c[2] = {&rhs1, &rhs2};
+    for (int r = 0; r < 2; ++r) {
+      double p1a = 0.0, p2a = 0.0, p1b = 0.0, p2b = 0.0;
+      for (int j = 0; j < n; ++j) {
+        double sgn = (j % 2 == 0) ? 1.0 : -1.0;
+        p1b += (*c[r])[j];
+        p2b += (*c[r])[n + j];
+        p1a += sgn * (*c[r])[j];
+        p2a += sgn * (*c[r])[n + j];
+      }
+      res[r] = p1b * wb[0] + p2b * wb[1] - p1a * wa[0] - p2a * wa[1];
+    }
+    return res;
+  }
+
+  // T_j(t) and dT_j/dt for j < n
+  static void chebyshev(int n, double t, double* T, double* dT) {
+    T[0] = 1.0;
+    dT[0] = 0.0;
+    if (n > 1) {
+      T[1] = t;
+      dT[1] = 1.0;
+    }
+    for (int j = 2; j < n; ++j) {
+      T[j] = 2.0 * t * T[j - 1] - T[j - 2];
+      dT[j] = 2.0 * T[j - 1] + 2.0 * t * dT[j - 1] - dT[j - 2];
+    }
+  }
+
+  // solve M x = y for two right-hand sides in place, partial pivoting
+  static void solve(std::vector<double>& M, int n, std::vector<double>& y1,
+                    std::vector<double>& y2) {
+    auto at = [&](int r, int c) -> double& {
+      return M[static_cast<size_t>(r) * n + c];
+    };
+    for (int c = 0; c < n; ++c) {
+      int piv = c;
+      for (int r = c + 1; r < n; ++r)
+        if (std::fabs(at(r, c)) > std::fabs(at(piv, c))) piv = r;
+      if (piv != c) {
+        for (int k = 0; k < n; ++k) std::swap(at(c, k), at(piv, k));
+        std::swap(y1[c], y1[piv]);
+        std::swap(y2[c], y2[piv]);
+      }
+      for (int r = c + 1; r < n; ++r) {
+        double m = at(r, c) / at(c, c);
+        if (m == 0.0) continue;
+        for (int k = c; k < n; ++k) at(r, k) -= m * at(c, k);
+        y1[r] -= m * y1[c];
+        y2[r] -= m * y2[c];
+      }
+    }
+    for (int c = n - 1; c >= 0; --c) {
+      for (int k = c + 1; k < n; ++k) {
+        y1[c] -= at(c, k) * y1[k];
+        y2[c] -= at(c, k) * y2[k];
+      }
+      y1[c] /= at(c, c);
+      y2[c] /= at(c, c);
+    }
+  }
+};
+
+#endif  // OSCILLATORY_H
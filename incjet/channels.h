@@ -0,0 +1,219 @@
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <cmath>
+
+// global constants
+constexpr double PI = M_PI;             // pi from GNU, not C++ standard
+constexpr double Nc = 3.0;              // number of colors
+constexpr double Cf = 4.0 / 3.0;        // Casimir factor for quarks
+constexpr double Ca = 3.0;              // Casimir factor for gluons
+constexpr int Nf = 5;                   // number of active quark flavours
+constexpr double gev2barn = 3.8938e-4;  // GeV^-2 to barn conversion factor
+
+// amplitude function shortcuts to speed up calculations
+static inline double ampA(double n1, double n2, double d) noexcept {
+  constexpr double Cf_o_Ca = Cf / Ca;
+  return Cf_o_Ca * (n1 * n1 + n2 * n2) / (d * d);
+}
+static inline double ampB(double n, double d1, double d2) noexcept {
+  constexpr double twoCf_o_Casq = 2.0 * Cf / (Ca * Ca);
+  return ampA(n, d1, d2) + ampA(n, d2, d1) - twoCf_o_Casq * (n * n) / (d1 * d2);
+}
+static inline double ampC(double n1, double n2, double d) noexcept {
+  constexpr double Cfsq_o_Casq = (Cf * Cf) / (Ca * Ca);
+  return Cfsq_o_Casq * (n1 * n1 + n2 * n2) / (n1 * n2) - ampA(n1, n2, d);
+}
+static inline double ampD(double n1, double n2, double n3) noexcept {
+  constexpr double twoCa_o_Cf = 2.0 * Ca / Cf;
+  return twoCa_o_Cf *
+         (Ca - n1 * n2 / (n3 * n3) - n1 * n3 / (n2 * n2) - n2 * n3 / (n1 * n1));
+}
+
+// phase-space point of the 2->2 process
+// particle kinematics: a(xa) + b(xb) -> c(pt,yc) + d(pt,yd)
+struct phasespace {
+  double xa, xb;             // momentum fractions
+  double pt, yc;             // measured jet
+  double mans, mant, manu;   // Mandelstam variables
+  double muren, mufac;       // renormalization and factorization scales
+  double factor;             // everything except alpha_s^2, PDF and |M|^2
+};
+
+// map (xa, yc, pt) to a phase-space point, false if kinematically forbidden
+static inline bool kinematics(double xa, double yc, double pt, double CME,
+                              double ymax, phasespace& ps) noexcept {
+  // integration follows: Rev.Mod.Phys. 59, 465 (1987), eq. (A3)
+  // different from dijet, single inclusive jet measures only one jet "c"
+  // this means only yc should be within rapidity limit, yd can be anything
+  // transverse momentum fraction
+  double xt = 2.0 * pt / CME;
+  // Given xb below, solve xa when xb==1
+  double xamin = (xt * std::exp(+yc)) / (2.0 - xt * std::exp(-yc));
+  if (xa < xamin || xa > 1.0) return false;
+  // Given s,t,u below, solve xb when s+t+u==0
+  double xb = (xa * xt * std::exp(-yc)) / (2.0 * xa - xt * std::exp(+yc));
+  // the range of xb is bounded by xamin, but for safety check
+  if (xb < 0.0 || xb > 1.0) return false;
+  ps.xa = xa;
+  ps.xb = xb;
+  ps.pt = pt;
+  ps.yc = yc;
+  // Mandelstam variables
+  ps.mans = +xa * xb * CME * CME;
+  ps.mant = -xa * pt * CME * std::exp(-yc);
+  ps.manu = -xb * pt * CME * std::exp(+yc);
+  // renormalization and factorization scales
+  // One can vary the scale by a small factor (typically between 0.5 and 2)
+  ps.muren = pt * 1.0;  // * 0.5, * 2.0
+  ps.mufac = ps.muren;
+  // |M|^2 to dσ/dt factor, without alpha_s^2
+  double ampsq_to_dsdt = PI / (ps.mans * ps.mans);
+  // pre-factor from momentum fraction
+  double pre_factor = 2.0 / PI * xa * xb / (2.0 * xa - xt * std::exp(+yc));
+  // Jacobian: E*d^3σ/d^3p = 1/(2*pi*pt) * d^2σ/(dpt dy)
+  double jacobian = 2.0 * PI * pt;
+  // convert dsig/dpt to dsig/dpt/dy
+  double diff_rap = 1.0 / (2.0 * ymax);
+  // convert GeV^{-2} to nano barn
+  double gev_to_nb = gev2barn * 1e9;
+  ps.factor = jacobian * pre_factor * ampsq_to_dsdt * diff_rap * gev_to_nb;
+  return true;
+}
+
+/*
+Here I am using a different summation scheme compared to other codes
+consider the following: q + g -> q + g
+  a(xa) -----+~~~~~ X
+             |
+  b(xb) ~~~~~+----- Y
+We first fix the initial PDF, which means quark carries xa, and gluon carries
+xb. If we are measuring X(pt,yc), then we are measuring a gluon jet, with
+t-channel amplitude. If we are measuring Y(pt,yd), then we are measuring a
+quark jet, with t<->u exchange in amplitude. In inclusive jet measurement, we
+measure both jets and sum both contributions. This is easily extended to
+other, especially asymmetric observables like inclusive hadron, hadron-jet.
+Because we know the exact flavour of the measured parton.
+
+The 2->2 subprocesses only see the PDF through six parton luminosities, so
+the cross section is written as sum_ch lumi[ch] * coef[ch]. This lets the
+PDF-dependent and the PDF-independent parts be evaluated separately.
+*/
+enum channel { ch_qqp, ch_qqb, ch_qq, ch_gq, ch_qg, ch_gg, nchannel };
+
+// parton luminosities from PDFs indexed as
+// flavour:   bb, cb, sb, db, ub,  g,  u,  d,  s,  c,  b
+// index(i):  -5  -4  -3  -2  -1   0   1   2   3   4   5
+// Nf + i:     0   1   2   3   4   5   6   7   8   9   10
+static inline void luminosities(const double* pdfa, const double* pdfb,
+                                double* lumi) noexcept {
+  double suma = 0.0, sumb = 0.0, diag = 0.0, qqb = 0.0, qq = 0.0;
+  for (int i = 1; i <= Nf; ++i) {
+    double qa = pdfa[Nf + i] + pdfa[Nf - i];
+    double qb = pdfb[Nf + i] + pdfb[Nf - i];
+    suma += qa;
+    sumb += qb;
+    diag += qa * qb;
+    qqb += pdfa[Nf + i] * pdfb[Nf - i] + pdfa[Nf - i] * pdfb[Nf + i];
+    qq += pdfa[Nf + i] * pdfb[Nf + i] + pdfa[Nf - i] * pdfb[Nf - i];
+  }
+  lumi[ch_qqp] = suma * sumb - diag;  // q + q' with q != q', any charge
+  lumi[ch_qqb] = qqb;
+  lumi[ch_qq] = qq;
+  lumi[ch_gq] = pdfa[Nf] * sumb;
+  lumi[ch_qg] = suma * pdfb[Nf];
+  lumi[ch_gg] = pdfa[Nf] * pdfb[Nf];
+}
+
+// matrix elements per luminosity channel
+// Rev.Mod.Phys. 59, 465 (1987)
+// QCD and Collider Physics, Ellis, Stirling and Webber, 1996
+static inline void coefficients(const phasespace& ps, bool do_Qjet,
+                                bool do_Gjet, double* coef) noexcept {
+  double s = ps.mans, t = ps.mant, u = ps.manu;
+  double Q = do_Qjet ? 1.0 : 0.0;
+  double G = do_Gjet ? 1.0 : 0.0;
+  // q + q' -> q + q'
+  coef[ch_qqp] = Q * (ampA(s, u, t) + ampA(s, t, u));
+  // q + qb -> q' + qb'  (sum over q' not equal to q)
+  // q + qb -> q + qb
+  // q + qb -> g + g     (identical final state)
+  coef[ch_qqb] = Q * (Nf - 1) * (ampA(t, u, s) + ampA(u, t, s)) +
+                 Q * (ampB(u, s, t) + ampB(t, s, u)) +
+                 G * 0.5 * 6.0 * (ampC(t, u, s) + ampC(u, t, s));
+  // q + q -> q + q      (identical final state)
+  coef[ch_qq] = Q * 0.5 * (ampB(s, t, u) + ampB(s, u, t));
+  // g + q -> g + q
+  coef[ch_gq] = (-9.0 / 4.0) * (G * ampC(s, u, t) + Q * ampC(s, t, u));
+  // q + g -> q + g
+  coef[ch_qg] = (-9.0 / 4.0) * (Q * ampC(s, u, t) + G * ampC(s, t, u));
+  // g + g -> q + qb     (sum over all final quark flavours)
+  // g + g -> g + g      (identical final state)
+  coef[ch_gg] = Q * Nf * (27.0 / 32.0) * (ampC(t, u, s) + ampC(u, t, s)) +
+                G * 0.5 * (ampD(s, t, u) + ampD(s, u, t));
+}
+
+// flavour-resolved sum for an identified final state, e.g. inclusive hadrons
+// the measured parton c fragments with D[Nf + i] (same indexing as the PDFs)
+// t = (pa - pc)^2, so the t-channel term of each subprocess has c coming
+// from a, and the t <-> u exchanged term has c coming from b
+// with D == 1 for all flavours it equals the inclusive jet result
+static inline double fragmented(const phasespace& ps, const double* pdfa,
+                                const double* pdfb, const double* D) noexcept {
+  double s = ps.mans, t = ps.mant, u = ps.manu;
+  double ga = pdfa[Nf], gb = pdfb[Nf], Dg = D[Nf];
+  // quark sums: plain, weighted by D, and fragmentation of q and qb
+  double sa = 0.0, sb = 0.0, saD = 0.0, sbD = 0.0, diaga = 0.0, diagb = 0.0;
+  double Sq = 0.0, Sqb = 0.0;
+  for (int i = 1; i <= Nf; ++i) {
+    double qa = pdfa[Nf + i] + pdfa[Nf - i];
+    double qb = pdfb[Nf + i] + pdfb[Nf - i];
+    double qaD = pdfa[Nf + i] * D[Nf + i] + pdfa[Nf - i] * D[Nf - i];
+    double qbD = pdfb[Nf + i] * D[Nf + i] + pdfb[Nf - i] * D[Nf - i];
+    sa += qa;
+    sb += qb;
+    saD += qaD;
+    sbD += qbD;
+    diaga += qaD * qb;
+    diagb += qa * qbD;
+    Sq += D[Nf + i];
+    Sqb += D[Nf - i];
+  }
+  // same-flavour pairs: qq, and q + qb with lumi "qqb"
+  // qqbA (qqbB): c has the flavour of a (b)
+  // qqbP (qqbM): c is a q' (qb') with the charge sign of a, q' != q
+  double qq = 0.0, qqb = 0.0, qqbA = 0.0, qqbB = 0.0, qqbP = 0.0, qqbM = 0.0;
+  for (int i = 1; i <= Nf; ++i) {
+    double Dp = D[Nf + i], Dm = D[Nf - i];
+    double lp = pdfa[Nf + i] * pdfb[Nf - i];  // a = q,  b = qb
+    double lm = pdfa[Nf - i] * pdfb[Nf + i];  // a = qb, b = q
+    qq += pdfa[Nf + i] * pdfb[Nf + i] * Dp + pdfa[Nf - i] * pdfb[Nf - i] * Dm;
+    qqb += lp + lm;
+    qqbA += lp * Dp + lm * Dm;
+    qqbB += lp * Dm + lm * Dp;
+    qqbP += lp * (Sq - Dp) + lm * (Sqb - Dm);
+    qqbM += lp * (Sqb - Dm) + lm * (Sq - Dp);
+  }
+  double sum = 0.0;
+  // q + q' -> q + q'
+  sum += (saD * sb - diaga) * ampA(s, u, t) + (sa * sbD - diagb) * ampA(s, t, u);
+  // q + qb -> q' + qb'
+  sum += qqbP * ampA(t, u, s) + qqbM * ampA(u, t, s);
+  // q + q -> q + q      (identical final state)
+  sum += 0.5 * qq * (ampB(s, t, u) + ampB(s, u, t));
+  // q + qb -> q + qb
+  sum += qqbA * ampB(u, s, t) + qqbB * ampB(t, s, u);
+  // q + qb -> g + g     (identical final state)
+  sum += qqb * Dg * 0.5 * 6.0 * (ampC(t, u, s) + ampC(u, t, s));
+  // g + g -> q + qb
+  sum += ga * gb * (27.0 / 32.0) * (Sq * ampC(t, u, s) + Sqb * ampC(u, t, s));
+  // g + q -> g + q
+  sum += (-9.0 / 4.0) * ga * (sb * Dg * ampC(s, u, t) + sbD * ampC(s, t, u));
+  // q + g -> q + g
+  sum += (-9.0 / 4.0) * gb * (saD * ampC(s, u, t) + sa * Dg * ampC(s, t, u));
+  // g + g -> g + g      (identical final state)
+  sum += ga * gb * Dg * 0.5 * (ampD(s, t, u) + ampD(s, u, t));
+  return sum;
+}
+
+#endif  // CHANNELS_H
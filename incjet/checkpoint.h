@@ -0,0 +1,263 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <fcntl.h>
+#include <gsl/gsl_monte_vegas.h>
+#include <gsl/gsl_rng.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Checkpoint of a bin-by-bin run: the columns of the finished bins and,
+// for the bin in progress, the VEGAS state and random numbers after its
+// warm-up. Every bin starts from a fresh generator (see vegasbin), so a
+// resumed run gives bitwise the same results as an uninterrupted one.
+// The file is written to <file>.tmp, synced and renamed, and then the
+// directory is synced, so a run killed while writing leaves the previous
+// checkpoint intact and a finished one survives a crash. A description of
+// the configuration is stored along, and a checkpoint of another
+// configuration is refused.
+
+// the atomic step of every checkpoint file: flush and sync f, just written
+// to tmp, close it and rename tmp to fname, then sync the directory so
+// that the rename itself survives a crash
+inline bool replace(FILE* f, const std::string& tmp,
+                    const std::string& fname) {
+  bool ok = std::fflush(f) == 0 && fsync(fileno(f)) == 0;
+  ok = (std::fclose(f) == 0) && ok &&
+       std::rename(tmp.c_str(), fname.c_str()) == 0;
+  if (!ok) return false;
+  size_t slash = fname.find_last_of('/');
+  std::string dir = slash == std::string::npos ? "."
+                    : slash == 0               ? "/"
+                                               : fname.substr(0, slash);
+  int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) return false;
+  ok = fsync(fd) == 0;
+  close(fd);
+  return ok;
+}
+
+class checkpoint {
+ public:
+  // columns: vectors of nbin values each, saved and restored in place
+  checkpoint(const std::string& fname, const std::string& config,
+             std::vector<std::vector<double>*> columns, double interval)
+      : fname(fname), config(config), columns(columns), interval(interval),
+        last(std::chrono::steady_clock::now()) {}
+  checkpoint(const checkpoint&) = delete;
+  checkpoint& operator=(const checkpoint&) = delete;
+  ~checkpoint() {
+    if (rng) gsl_rng_free(rng);
+  }
+
+  size_t done = 0;  // finished bins, 0 ... done-1
+
+  // read the checkpoint, false with a message if it does not fit the run
+  bool load() {
+    FILE* f = std::fopen(fname.c_str(), "rb");
+    if (!f) return error("unable to read " + fname);
+    char m[sizeof(magic)];
+    uint64_t len = 0, n = 0, d = 0;
+    uint8_t hot = 0;
+    bool ok = get(f, m) && std::memcmp(m, magic, sizeof(m)) == 0 &&
+              get(f, len) && len < (1 << 20);
+    std::string cfg(ok ? len : 0, ' ');
+    ok = ok && std::fread(&cfg[0], 1, len, f) == len;
+    ok = ok && get(f, n) && get(f, d) && get(f, hot);
+    if (!ok || cfg != config || n != nbin() || d > n) {
+      std::fclose(f);
+      return error(ok ? fname + " is of another configuration"
+                      : fname + " is not a checkpoint");
+    }
+    for (std::vector<double>* c : columns)
+      ok = ok && std::fread(c->data(), sizeof(double), n, f) == n;
+    warm = hot != 0;
+    if (warm) {
+      ok = ok && get(f, res) && get(f, err) && vegas.read(f);
+      if (!rng) rng = gsl_rng_alloc(gsl_rng_default);
+      ok = ok && gsl_rng_fread(f, rng) == 0;
+    }
+    std::fclose(f);
+    if (!ok) return error(fname + " is truncated");
+    done = static_cast<size_t>(d);
+    return true;
+  }
+
+  // forget the loaded checkpoint, the run starts from the first bin
+  void reset() {
+    done = 0;
+    warm = false;
+  }
+
+  // VEGAS state and random numbers of bin "done" after its warm-up, if
+  // they are in the checkpoint, with the warm-up result
+  bool restore(gsl_monte_vegas_state* s, gsl_rng* r, double& result,
+               double& abserr) {
+    if (!warm || !vegas.restore(s)) return false;
+    gsl_rng_memcpy(r, rng);
+    result = res;
+    abserr = err;
+    warm = false;
+    return true;
+  }
+
+  // true once the interval has passed since the last save
+  bool due() const {
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - last;
+    return dt.count() >= interval;
+  }
+
+  // save the finished bins, and bin "done" after its warm-up if s != null
+  bool save(const gsl_monte_vegas_state* s = nullptr,
+            const gsl_rng* r = nullptr, double result = 0.0,
+            double abserr = 0.0) {
+    std::string tmp = fname + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    uint64_t len = config.size(), n = nbin(), d = done;
+    uint8_t hot = s ? 1 : 0;
+    bool ok = put(f, magic) && put(f, len) &&
+              std::fwrite(config.data(), 1, len, f) == len && put(f, n) &&
+              put(f, d) && put(f, hot);
+    for (const std::vector<double>* c : columns)
+      ok = ok && std::fwrite(c->data(), sizeof(double), n, f) == n;
+    if (s) {
+      vegasstate v;
+      v.save(s);
+      ok = ok && put(f, result) && put(f, abserr) && v.write(f) &&
+           gsl_rng_fwrite(f, r) == 0;
+    }
+    // a failed write leaves the previous checkpoint in place
+    if (ok)
+      ok = replace(f, tmp, fname);
+    else
+      std::fclose(f);
+    last = std::chrono::steady_clock::now();
+    return ok;
+  }
+
+ private:
+  static constexpr char magic[8] = {'I', 'J', 'C', 'K', 'P', 'T', '0', '1'};
+  std::string fname, config;
+  std::vector<std::vector<double>*> columns;
+  double interval;
+  std::chrono::steady_clock::time_point last;
+  // warm-up state of bin "done" from load()
+  bool warm = false;
+  double res = 0.0, err = 0.0;
+  gsl_rng* rng = nullptr;
+
+  // the fields of gsl_monte_vegas_state that carry over between stages,
+  // the remaining arrays are scratch space of a single iteration
+  struct vegasstate {
+    uint64_t dim = 0, bins_max = 0;
+    uint32_t bins = 0, boxes = 0, iterations = 0;
+    uint32_t it_start = 0, it_num = 0, samples = 0, calls_per_box = 0;
+    int32_t mode = 0, stage = 0;
+    double vol = 0.0, jac = 0.0, alpha = 0.0;
+    double wtd_int_sum = 0.0, sum_wgts = 0.0, chi_sum = 0.0, chisq = 0.0;
+    double result = 0.0, sigma = 0.0;
+    std::vector<double> xi, delx;
+
+    void save(const gsl_monte_vegas_state* s) {
+      dim = s->dim;
+      bins_max = s->bins_max;
+      bins = s->bins;
+      boxes = s->boxes;
+      iterations = s->iterations;
+      it_start = s->it_start;
+      it_num = s->it_num;
+      samples = s->samples;
+      calls_per_box = s->calls_per_box;
+      mode = s->mode;
+      stage = s->stage;
+      vol = s->vol;
+      jac = s->jac;
+      alpha = s->alpha;
+      wtd_int_sum = s->wtd_int_sum;
+      sum_wgts = s->sum_wgts;
+      chi_sum = s->chi_sum;
+      chisq = s->chisq;
+      result = s->result;
+      sigma = s->sigma;
+      xi.assign(s->xi, s->xi + (bins_max + 1) * dim);
+      delx.assign(s->delx, s->delx + dim);
+    }
+    bool restore(gsl_monte_vegas_state* s) const {
+      if (s->dim != dim || s->bins_max != bins_max) return false;
+      s->bins = bins;
+      s->boxes = boxes;
+      s->iterations = iterations;
+      s->it_start = it_start;
+      s->it_num = it_num;
+      s->samples = samples;
+      s->calls_per_box = calls_per_box;
+      s->mode = mode;
+      s->stage = stage;
+      s->vol = vol;
+      s->jac = jac;
+      s->alpha = alpha;
+      s->wtd_int_sum = wtd_int_sum;
+      s->sum_wgts = sum_wgts;
+      s->chi_sum = chi_sum;
+      s->chisq = chisq;
+      s->result = result;
+      s->sigma = sigma;
+      std::copy(xi.begin(), xi.end(), s->xi);
+      std::copy(delx.begin(), delx.end(), s->delx);
+      return true;
+    }
+    bool write(FILE* f) const {
+      return put(f, dim) && put(f, bins_max) && put(f, bins) &&
+             put(f, boxes) && put(f, iterations) && put(f, it_start) &&
+             put(f, it_num) && put(f, samples) && put(f, calls_per_box) &&
+             put(f, mode) && put(f, stage) && put(f, vol) && put(f, jac) &&
+             put(f, alpha) && put(f, wtd_int_sum) && put(f, sum_wgts) &&
+             put(f, chi_sum) && put(f, chisq) && put(f, result) &&
+             put(f, sigma) &&
+             std::fwrite(xi.data(), sizeof(double), xi.size(), f) ==
+                 xi.size() &&
+             std::fwrite(delx.data(), sizeof(double), dim, f) == dim;
+    }
+    bool read(FILE* f) {
+      bool ok = get(f, dim) && get(f, bins_max) && dim < 64 &&
+                bins_max < 4096 && get(f, bins) && get(f, boxes) &&
+                get(f, iterations) && get(f, it_start) && get(f, it_num) &&
+                get(f, samples) && get(f, calls_per_box) && get(f, mode) &&
+                get(f, stage) && get(f, vol) && get(f, jac) &&
+                get(f, alpha) && get(f, wtd_int_sum) && get(f, sum_wgts) &&
+                get(f, chi_sum) && get(f, chisq) && get(f, result) &&
+                get(f, sigma);
+      if (!ok) return false;
+      xi.resize((bins_max + 1) * dim);
+      delx.resize(dim);
+      return std::fread(xi.data(), sizeof(double), xi.size(), f) ==
+                 xi.size() &&
+             std::fread(delx.data(), sizeof(double), dim, f) == dim;
+    }
+  } vegas;
+
+  size_t nbin() const { return columns.empty() ? 0 : columns[0]->size(); }
+  bool error(const std::string& msg) const {
+    std::cerr << "Error: checkpoint: " << msg << std::endl;
+    return false;
+  }
+  template <typename T>
+  static bool put(FILE* f, const T& v) {
+    return std::fwrite(&v, sizeof(T), 1, f) == 1;
+  }
+  template <typename T>
+  static bool get(FILE* f, T& v) {
+    return std::fread(&v, sizeof(T), 1, f) == 1;
+  }
+};
+
+#endif  // CHECKPOINT_H
@@ -44,18 +44,67 @@ fi
 # Compilation commands
 # ==========================================
 echo "Cleaning previous build..."
-rm -f incjet.exe *.o results.txt
+rm -f incjet.exe convolute.exe inchad.exe incpho.exe regress.exe incevt.exe incscan.exe incscan_mpi.exe *.o results.txt
 
 echo "Compiling ct11pdf.cc..."
 g++ -c ct11pdf.cc
 
+# optional HDF5 result store (incjet --store), e.g. from libhdf5-dev
+HDF5_FLAGS=""
+HDF5_LIBS=""
+if pkg-config --exists hdf5 2>/dev/null; then
+    HDF5_FLAGS="-DHAVE_HDF5 $(pkg-config --cflags hdf5)"
+    HDF5_LIBS="$(pkg-config --libs hdf5)"
+    echo "HDF5 found, result store enabled"
+fi
+
+# optional profiling zones (../timer/timer.h): PROFILE=1 ./compile.sh
+PROFILE_FLAGS=""
+if [[ "${PROFILE:-0}" == "1" ]]; then
+    PROFILE_FLAGS="-DPROFILE -DTIMER_TSC"
+    echo "Profiling zones enabled"
+fi
+
 echo "Compiling incjet.cpp..."
-g++ -Wall -Wextra -Wpedantic -O3 -c incjet.cpp
+g++ -Wall -Wextra -Wpedantic -O3 $HDF5_FLAGS $PROFILE_FLAGS -c incjet.cpp
+
+echo "Compiling convolute.cpp..."
+g++ -Wall -Wextra -Wpedantic -O3 $PROFILE_FLAGS -c convolute.cpp
+
+echo "Compiling inchad.cpp..."
+g++ -Wall -Wextra -Wpedantic -O3 $PROFILE_FLAGS -c inchad.cpp
 
-echo "Linking executable..."
-g++ -o incjet.exe ct11pdf.o incjet.o -lgsl
+echo "Compiling incpho.cpp..."
+g++ -Wall -Wextra -Wpedantic -O3 $PROFILE_FLAGS -c incpho.cpp
+
+echo "Compiling regress.cpp..."
+g++ -Wall -Wextra -Wpedantic -O3 -c regress.cpp
+
+echo "Compiling incevt.cpp..."
+g++ -Wall -Wextra -Wpedantic -O3 -pthread $PROFILE_FLAGS -c incevt.cpp
+
+echo "Compiling incscan.cpp..."
+g++ -Wall -Wextra -Wpedantic -O3 -pthread $HDF5_FLAGS $PROFILE_FLAGS -c incscan.cpp
+
+echo "Linking executables..."
+g++ -o incjet.exe ct11pdf.o incjet.o -lgsl $HDF5_LIBS
+g++ -o convolute.exe ct11pdf.o convolute.o
+g++ -o inchad.exe ct11pdf.o inchad.o -lgsl
+g++ -o incpho.exe ct11pdf.o incpho.o -lgsl
+g++ -o regress.exe regress.o
+g++ -pthread -o incevt.exe ct11pdf.o incevt.o -lgsl
+g++ -pthread -o incscan.exe ct11pdf.o incscan.o -lgsl $HDF5_LIBS
+
+# optional MPI version of incscan, e.g. from libopenmpi-dev
+if command -v mpicxx >/dev/null 2>&1; then
+    echo "Compiling incscan.cpp with MPI..."
+    mpicxx -Wall -Wextra -Wpedantic -O3 -pthread -DHAVE_MPI -DOMPI_SKIP_MPICXX \
+        -DMPICH_SKIP_MPICXX $HDF5_FLAGS $PROFILE_FLAGS -c incscan.cpp -o incscan_mpi.o
+    mpicxx -pthread -o incscan_mpi.exe ct11pdf.o incscan_mpi.o -lgsl $HDF5_LIBS
+    echo "MPI found, incscan_mpi.exe built"
+fi
 
 echo "----------------------------------------"
-echo "Build complete: incjet.exe"
+echo "Build complete: incjet.exe convolute.exe inchad.exe incpho.exe regress.exe incevt.exe incscan.exe"
 echo "You can now run it with ./incjet.exe"
 echo "----------------------------------------"
@@ -3,6 +3,13 @@
 
 //------------------------------------------------------------------------------------
 void cteqpdf::setct11(string fname)
+{
+     if (!readct11(fname)) exit(0);
+}
+
+//------------------------------------------------------------------------------------
+// same as setct11, but returns false on a missing or malformed table
+bool cteqpdf::readct11(string fname)
 {
      JX=0;
      JQ=0;
@@ -19,6 +26,7 @@ void cteqpdf::setct11(string fname)
      if (!infile) {
 	     cerr << "error: unable to open input file: "
 	     << fname <<endl;
+	     return false;
      }
 
      getline(infile, aline);
@@ -65,6 +73,14 @@ void cteqpdf::setct11(string fname)
      infile >> NX >> NT >> N0 >> NG >> N0;
      getline(infile, aline);
 
+// the grid must fit the arrays
+     if (!infile || NX < 3 || NX > MXX || NT < 1 || NT > MXQ || NG < 0 ||
+         Nfmx < 0 || Nfmx > MXF || MxVal < 0 || MxVal > MaxVal) {
+	     cout << "Wrong in the table!" << "\n" << "bad header in " << fname << endl;
+	     ipdsset=0;
+	     return false;
+     }
+
      if (NG > 0) {
 	     for(int i=1; i<=(NG+1); i++) getline(infile, aline); 
      }
@@ -84,10 +100,11 @@ void cteqpdf::setct11(string fname)
 
      qbase1=qv[1]/exp(exp(TV[1]));
      qbase2=qv[NT]/exp(exp(TV[NT]));
-     if (fabs(qbase1-qbase2) > 1e-5) {
+     if (!infile || !(fabs(qbase1-qbase2) <= 1e-5)) {
 	     cout << "Readpds0: something wrong with qbase" <<endl;
 	     cout << "qbase1, qbase2= " << qbase1 << " " <<qbase2 <<endl;
-	     exit(0);
+	     ipdsset=0;
+	     return false;
      }
      else{
 	     qbase=(qbase1+qbase2)/2;
@@ -97,6 +114,11 @@ void cteqpdf::setct11(string fname)
      infile >> XMIN >> aa;
      XV[0]=0;
      for (int i=1; i<=NX; i++) infile >> XV[i];
+     if (!infile) {
+	     cout << "Wrong in the table!" << "\n" << "bad x grid in " << fname << endl;
+	     ipdsset=0;
+	     return false;
+     }
      Nblk=(NX+1)*(NT+1);
      Npts=Nblk*(Nfmx+1+MxVal);
      getline(infile, aline);
@@ -117,14 +139,16 @@ void cteqpdf::setct11(string fname)
 
      if (rch != Npts) {
 	     cout << "Wrong in the table!" << "\n" << "length not match!" << endl;
-	     exit(0);
+	     UPD.clear();
+	     ipdsset=0;
+	     return false;
      }
 
      int j=Npts-1;
 
      infile.clear();
      infile.close();
-
+     return true;
 }
 
 //------------------------------------------------------------------------------------
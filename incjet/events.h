@@ -0,0 +1,176 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+#include "channels.h"
+
+// 2->2 events a(xa) + b(xb) -> c(pt, yc) + d(pt, yd) in a compact binary
+// file: a fixed header followed by packed 32-byte records, in the native
+// byte order. The header size is a multiple of 8 bytes, so a memory mapped
+// file is directly an array of event, see eventfile.
+struct event {
+  double weight;      // cross section in nb, summing to eventheader::sigma
+  float xa, xb;       // momentum fractions
+  float pt, yc, yd;   // transverse momentum and rapidities of c and d
+  uint32_t channel;   // luminosity channel of channels.h, a and b in order
+};
+static_assert(sizeof(event) == 32, "event records are packed");
+
+struct eventheader {
+  char magic[8];          // IJEVTS01
+  uint64_t nevent;        // number of records
+  uint32_t record;        // sizeof(event)
+  uint32_t unweighted;    // 1 if the weights are sigma / nevent, up to
+                          // the rare events above the maximum weight
+  double CME;             // collision energy in GeV
+  double ptmin, ptmax;    // pt range of c
+  double ymin, ymax;      // rapidity range of c
+  double sigma, error;    // total cross section in nb and its error
+};
+static_assert(sizeof(eventheader) % 8 == 0, "records stay 8-byte aligned");
+
+// sequential writer, the number of events goes into the header at close
+class eventwriter {
+ public:
+  bool open(const std::string& fname, const eventheader& h) {
+    head = h;
+    std::memcpy(head.magic, magic, sizeof(magic));
+    head.nevent = 0;
+    head.record = sizeof(event);
+    out.open(fname, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+    return static_cast<bool>(out);
+  }
+  void write(const event* e, size_t n) {
+    out.write(reinterpret_cast<const char*>(e),
+              static_cast<std::streamsize>(n * sizeof(event)));
+    head.nevent += n;
+  }
+  // final header with the event count (and the updated cross section)
+  bool close(double sigma, double error) {
+    head.sigma = sigma;
+    head.error = error;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+    out.close();
+    return !out.fail();
+  }
+
+ private:
+  std::ofstream out;
+  eventheader head;
+  static constexpr char magic[8] = {'I', 'J', 'E', 'V', 'T', 'S', '0', '1'};
+};
+
+// read-only memory map of an event file, the records are used in place
+class eventfile {
+ public:
+  eventfile() = default;
+  eventfile(const eventfile&) = delete;
+  eventfile& operator=(const eventfile&) = delete;
+  ~eventfile() {
+    if (map) munmap(map, length);
+  }
+
+  bool open(const std::string& fname) {
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(eventheader)) {
+      ::close(fd);
+      return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+    void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+    map = m;
+    const eventheader& h = header();
+    if (std::memcmp(h.magic, "IJEVTS01", 8) != 0 || h.record != sizeof(event))
+      return false;
+    // a run that did not finish has no count yet, but whole records
+    size_t fit = (length - sizeof(eventheader)) / sizeof(event);
+    count = (h.nevent > 0 && h.nevent <= fit) ? h.nevent : fit;
+    return true;
+  }
+
+  const eventheader& header() const {
+    return *static_cast<const eventheader*>(map);
+  }
+  const event* begin() const {
+    return reinterpret_cast<const event*>(static_cast<const char*>(map) +
+                                          sizeof(eventheader));
+  }
+  const event* end() const { return begin() + count; }
+  size_t size() const { return count; }
+
+ private:
+  void* map = nullptr;
+  size_t length = 0, count = 0;
+};
+
+// HepMC3 ASCII (Asciiv3) output for other tools. The records only carry
+// the luminosity channel, so the partons get the flavours of a typical
+// subprocess of it: u for quarks, ub for the antiquark of ch_qqb, d for
+// the second quark of ch_qqp. The azimuth phi of c is free.
+class hepmcwriter {
+ public:
+  bool open(const std::string& fname, double cme) {
+    CME = cme;
+    out.open(fname);
+    out << "HepMC::Version 3.02.06\n"
+        << "HepMC::Asciiv3-START_EVENT_LISTING\n"
+        << std::scientific << std::setprecision(8);
+    return static_cast<bool>(out);
+  }
+  void write(const event& e, double phi) {
+    // PDG codes of a, b (and c, d)
+    static constexpr int pdg[nchannel][2] = {{2, 1}, {2, -2}, {2, 2},
+                                             {21, 2}, {2, 21}, {21, 21}};
+    const int* id = pdg[std::min<uint32_t>(e.channel, ch_gg)];
+    double Ea = 0.5 * e.xa * CME, Eb = 0.5 * e.xb * CME;
+    double px = e.pt * std::cos(phi), py = e.pt * std::sin(phi);
+    out << "E " << nevent++ << " 1 4\n"
+        << "U GEV MM\n"
+        << "W " << e.weight << '\n';
+    particle(1, 0, id[0], 0.0, 0.0, +Ea, Ea, 4);
+    particle(2, 0, id[1], 0.0, 0.0, -Eb, Eb, 4);
+    out << "V -1 0 [1,2]\n";
+    particle(3, -1, id[0], +px, +py, e.pt * std::sinh(e.yc),
+             e.pt * std::cosh(e.yc), 1);
+    particle(4, -1, id[1], -px, -py, e.pt * std::sinh(e.yd),
+             e.pt * std::cosh(e.yd), 1);
+  }
+  bool close() {
+    out << "HepMC::Asciiv3-END_EVENT_LISTING\n";
+    out.close();
+    return !out.fail();
+  }
+
+ private:
+  std::ofstream out;
+  double CME = 0.0;
+  size_t nevent = 0;
+
+  // P id parent-vertex pdg px py pz E m status, massless partons
+  void particle(int n, int vertex, int id, double px, double py, double pz,
+                double E, int status) {
+    out << "P " << n << ' ' << vertex << ' ' << id << ' ' << px << ' ' << py
+        << ' ' << pz << ' ' << E << " 0 " << status << '\n';
+  }
+};
+
+#endif  // EVENTS_H
@@ -0,0 +1,49 @@
+#ifndef FFGRID_H
+#define FFGRID_H
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "flavgrid.h"
+
+// Fragmentation functions D_i^h(z, Q) of partons into a hadron h.
+// Grid file format (plain text, '#' starts a comment line): a flavgrid
+// table with x -> z, see flavgrid.h. Use the same interface as cteqpdf:
+// "ff.setff(file)", then "ff.fragment(ip, z, Q)" for one flavour, or the
+// batched "ff.fragments(z, Q, D)" that fills all 11 flavours at once.
+class ffgrid {
+ public:
+  // name of the grid file
+  std::string fileff;
+
+  // read the grid from file, false on error
+  bool setff(const std::string& fname) {
+    fileff = fname;
+    std::ifstream infile(fname);
+    if (!infile) {
+      std::cerr << "error: unable to open input file: " << fname << std::endl;
+      return false;
+    }
+    std::stringstream data;
+    std::string aline;
+    while (std::getline(infile, aline))
+      if (aline.empty() || aline[0] != '#') data << aline << '\n';
+    if (!D.read(data)) {
+      std::cerr << "Wrong in the FF table!" << "\n"
+                << "length not match!" << std::endl;
+      return false;
+    }
+    std::cout << "FF grid " << fname << " read..." << std::endl;
+    return true;
+  }
+
+  double fragment(int ip, double z, double Q) const { return D.value(ip, z, Q); }
+  void fragments(double z, double Q, double* out) const { D.values(z, Q, out); }
+
+ private:
+  flavgrid D;
+};
+
+#endif  // FFGRID_H
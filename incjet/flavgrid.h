@@ -0,0 +1,112 @@
+#ifndef FLAVGRID_H
+#define FLAVGRID_H
+
+#include <cmath>
+#include <istream>
+#include <vector>
+
+// Table of 11 flavours (bb cb sb db ub g u d s c b) on an (x, Q) grid,
+// interpolated the way cteqpdf does it: 4-point polynomials in s = x^0.3
+// and t = ln ln(Q/qbase), with the interval kept in the middle of the
+// stencil away from the edges. The stencil only depends on (x, Q), so the
+// batched values() finds it once and applies it to all 11 flavours, which
+// are stored next to each other.
+//
+// The interpolation is a deliberate copy, not shared with ct11pdf.cc:
+// cteqpdf is the vendored CTEQ interface, kept as distributed, whose
+// interpolation is unrolled over its member state, works one flavour at a
+// time on the .pds layout and treats small x and the grid edges in its own
+// way. Reworking it into a shared helper would change the code behind
+// every PDF value of the program; this class only repeats the choice of
+// variables and the 4-point stencil.
+//
+// Table layout (plain numbers, after any header of the owning class):
+//   NX NQ
+//   x(1) ... x(NX)          increasing, 0 < x <= 1
+//   Q(1) ... Q(NQ)          increasing, Q > qbase
+//   then for each Q, NX lines of 11 values in flavour order -5 .. 5
+// Outside the grid the edge polynomials are used, so stay close to it.
+class flavgrid {
+ public:
+  static constexpr int nflav = 11;
+
+  // read the table, false on error
+  bool read(std::istream& data) {
+    data >> NX >> NQ;
+    if (!data || NX < 4 || NQ < 4) return false;
+    SV.resize(NX);
+    TV.resize(NQ);
+    for (auto& s : SV) {
+      data >> s;
+      s = std::pow(s, xpow);
+    }
+    for (auto& t : TV) {
+      data >> t;
+      if (t <= qbase) return false;
+      t = std::log(std::log(t / qbase));
+    }
+    UPD.resize(static_cast<size_t>(NQ) * NX * nflav);
+    for (auto& u : UPD) data >> u;
+    return static_cast<bool>(data);
+  }
+
+  // all flavours at (x, Q), out[5 + i] for i = -5..5
+  void values(double x, double Q, double* out) const {
+    double ws[4], wt[4];
+    int jx = stencil(SV, std::pow(x, xpow), ws);
+    int jq = stencil(TV, std::log(std::log(Q / qbase)), wt);
+    for (int f = 0; f < nflav; ++f) out[f] = 0.0;
+    for (int iq = 0; iq < 4; ++iq) {
+      for (int ix = 0; ix < 4; ++ix) {
+        double w = wt[iq] * ws[ix];
+        const double* u = &UPD[(static_cast<size_t>(jq + iq) * NX + jx + ix) * nflav];
+        for (int f = 0; f < nflav; ++f) out[f] += w * u[f];
+      }
+    }
+  }
+
+  // single flavour ip = -5..5 at (x, Q)
+  double value(int ip, double x, double Q) const {
+    double ws[4], wt[4];
+    int jx = stencil(SV, std::pow(x, xpow), ws);
+    int jq = stencil(TV, std::log(std::log(Q / qbase)), wt);
+    double sum = 0.0;
+    for (int iq = 0; iq < 4; ++iq)
+      for (int ix = 0; ix < 4; ++ix)
+        sum += wt[iq] * ws[ix] *
+               UPD[(static_cast<size_t>(jq + iq) * NX + jx + ix) * nflav + 5 + ip];
+    return sum;
+  }
+
+ private:
+  static constexpr double xpow = 0.3;   // as cteqpdf::xpow
+  static constexpr double qbase = 0.2;  // GeV, t = ln ln(Q/qbase)
+  int NX = 0, NQ = 0;
+  std::vector<double> SV, TV;  // interpolation variables of the nodes
+  std::vector<double> UPD;     // [Q][x][flavour]
+
+  // binary search for the interval, then 4-point Lagrange weights
+  static int stencil(const std::vector<double>& v, double t, double* w) {
+    int n = static_cast<int>(v.size());
+    int jl = -1, ju = n;
+    while (ju - jl > 1) {
+      int jm = (ju + jl) / 2;
+      if (t >= v[jm])
+        jl = jm;
+      else
+        ju = jm;
+    }
+    // keep t in the middle interval of the stencil
+    int j = jl - 1;
+    if (j < 0) j = 0;
+    if (j > n - 4) j = n - 4;
+    for (int i = 0; i < 4; ++i) {
+      w[i] = 1.0;
+      for (int k = 0; k < 4; ++k)
+        if (k != i) w[i] *= (t - v[j + k]) / (v[j + i] - v[j + k]);
+    }
+    return j;
+  }
+};
+
+#endif  // FLAVGRID_H
@@ -0,0 +1,427 @@
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "channels.h"
+#include "ct11pdf.h"
+#include "events.h"
+#include "lumitable.h"
+#include "process.h"
+#include "processes.h"
+#include "spscqueue.h"
+#include "vegasgrid.h"
+#include "../timer/timer.h"
+
+// Event generation for single inclusive jets: the pt range is cut into
+// slices, VEGAS adapts a grid in each of them, and the adapted grids are
+// then sampled directly (vegasgrid.h), so every point is an event with a
+// known weight. Weighted events come from all slices equally often, so the
+// high pt tail is populated; unweighted events need slices chosen with
+// probability proportional to their cross section, and are accepted with
+// probability weight / (largest weight of the slice). The luminosity
+// channel is chosen with probability proportional to its contribution.
+// Producer threads, each with its own PDF copy and random numbers, pass
+// the events through lock-free queues to the writer in the main thread.
+
+// weight of every channel at a phase-space point, false if forbidden
+bool contributions(const double* dx, parameters<jet>& p, phasespace& ps,
+                   double* w) {
+  if (!jet::kinematics(dx, p, ps)) return false;
+  double pdfa[2 * Nf + 1], pdfb[2 * Nf + 1];
+  double lumi[nchannel], coef[nchannel];
+  if (!p.lumi || !p.lumi->evaluate(ps.xa, ps.xb, ps.mufac, lumi)) {
+    partons(p, ps.xa, ps.mufac, pdfa);
+    partons(p, ps.xb, ps.mufac, pdfb);
+    jet::luminosities(pdfa, pdfb, lumi);
+  }
+  jet::coefficients(ps, p, coef);
+  double norm = ps.factor * jet::coupling(p.ct18anlo.alphas(ps.mufac));
+  for (int ch = 0; ch < nchannel; ++ch)
+    w[ch] = std::max(0.0, norm * lumi[ch] * coef[ch]);
+  return true;
+}
+
+// pt slice: adapted grid and the weights of a pre-scan, all in nb
+struct slice {
+  vegasgrid grid;
+  double sigma, error;  // cross section of the slice
+  double mean;          // mean weight of the points with weight > 0
+  double wmax;          // largest weight, for unweighting
+  double prob;          // probability to choose the slice
+};
+
+// settings shared by all producers
+struct generator {
+  std::vector<slice> slices;
+  std::vector<double> cdf;  // cumulative probability of the slices
+  double sigma, error;      // total cross section
+  double dy;                // rapidity range, weights are integrated over y
+  size_t nevent;            // events of all producers
+  bool unweighted;
+};
+
+// per producer statistics
+struct counters {
+  size_t tried = 0;       // sampled points
+  size_t overweight = 0;  // unweighted events above the largest weight
+};
+
+// producer: n events from its own PDF copy and random numbers
+void produce(const generator& g, parameters<jet> p, unsigned long seed,
+             size_t n, spscqueue<event>& queue, counters& cnt) {
+  PROFILE_ZONE("produce");
+  gsl_rng* r = gsl_rng_alloc(gsl_rng_default);
+  gsl_rng_set(r, seed);
+  double nevent = static_cast<double>(g.nevent);
+  constexpr size_t block = 256;
+  event buf[block];
+  size_t nbuf = 0;
+  double dx[jet::ndim], w[nchannel];
+  phasespace ps;
+  for (size_t i = 0; i < n; ++i) {
+    // slice k with probability prob_k
+    size_t k = static_cast<size_t>(
+        std::upper_bound(g.cdf.begin(), g.cdf.end(), gsl_rng_uniform(r)) -
+        g.cdf.begin());
+    const slice& s = g.slices[std::min(k, g.slices.size() - 1)];
+    // point with weight > 0, hit-or-miss for unweighted events
+    double wgt, sum;
+    for (;;) {
+      ++cnt.tried;
+      wgt = s.grid.sample(r, dx) * g.dy;
+      if (!contributions(dx, p, ps, w)) continue;
+      sum = 0.0;
+      for (int ch = 0; ch < nchannel; ++ch) sum += w[ch];
+      wgt *= sum;
+      if (wgt <= 0.0) continue;
+      if (!g.unweighted || gsl_rng_uniform(r) * s.wmax < wgt) break;
+    }
+    // channel with probability proportional to its contribution
+    double u = gsl_rng_uniform(r) * sum;
+    int ch = 0;
+    while (ch < nchannel - 1 && u >= w[ch]) u -= w[ch++];
+    // rapidity of d from xa = xt / 2 * (exp(yc) + exp(yd))
+    double xt = 2.0 * ps.pt / p.CME;
+    event& e = buf[nbuf++];
+    e.xa = static_cast<float>(ps.xa);
+    e.xb = static_cast<float>(ps.xb);
+    e.pt = static_cast<float>(ps.pt);
+    e.yc = static_cast<float>(ps.yc);
+    e.yd = static_cast<float>(std::log(2.0 * ps.xa / xt - std::exp(ps.yc)));
+    e.channel = static_cast<uint32_t>(ch);
+    // weights sum to sigma_k in slice k
+    double unit = s.sigma / (s.prob * nevent);
+    if (g.unweighted) {
+      // overweight events keep their excess, so the sum stays unbiased
+      if (wgt > s.wmax) ++cnt.overweight;
+      e.weight = unit * std::max(1.0, wgt / s.wmax);
+    } else {
+      e.weight = unit * wgt / s.mean;
+    }
+    if (nbuf == block || i + 1 == n) {
+      for (size_t done = 0; done < nbuf;) {
+        size_t m = queue.push(buf + done, nbuf - done);
+        if (m == 0) std::this_thread::yield();
+        done += m;
+      }
+      nbuf = 0;
+    }
+  }
+  gsl_rng_free(r);
+}
+
+// histogram the pt of c of an event file, same columns as results.txt
+int readevents(const std::string& fname, size_t nbin) {
+  Timer timer;
+  eventfile ev;
+  if (!ev.open(fname)) {
+    std::cerr << "Error: unable to read " << fname << std::endl;
+    return 1;
+  }
+  const eventheader& head = ev.header();
+  double dy = head.ymax - head.ymin;
+  histogram h(nbin, head.ptmin, head.ptmax);
+  std::vector<double> sum(nbin), sum2(nbin);
+  double total = 0.0;
+  {
+    PROFILE_ZONE("read events");
+    for (const event& e : ev) {
+      total += e.weight;
+      if (e.pt < h.hmin || e.pt >= h.hmax) continue;
+      size_t i = static_cast<size_t>((e.pt - h.hmin) / h.bin);
+      if (i >= nbin) i = nbin - 1;
+      sum[i] += e.weight;
+      sum2[i] += e.weight * e.weight;
+    }
+  }
+  for (size_t i = 0; i < nbin; ++i)
+    h.set(i, sum[i] / dy, std::sqrt(sum2[i]) / dy);
+  double elapsed = timer.elapsed();
+  std::cout << "#   x    \t    y    \t   error  " << std::endl;
+  h.print(std::cout);
+  std::ofstream fout("results_events.txt", std::ios::out);
+  h.print(fout);
+  fout.close();
+  std::cout << "--------------------------------------------" << std::endl
+            << std::defaultfloat << " Events: " << ev.size()
+            << (head.unweighted ? " unweighted" : " weighted") << "\n"
+            << " Sum of weights: " << total << " nb, header " << head.sigma
+            << " +- " << head.error << " nb\n"
+            << " Read time: " << elapsed << " seconds\n"
+            << "--------------------------------------------" << std::endl;
+  Profile::report(std::cout);
+  return 0;
+}
+
+// main program
+int main(int argc, char* argv[]) {
+  // command line options
+  // --events <n>:   number of events, default 1000000
+  // --unweighted:   events of equal weight, default weighted
+  // --threads <n>:  producer threads, default all cores
+  // --out <file>:   binary event file, default events.bin
+  // --hepmc <file>: also write the events as HepMC3 ASCII
+  // --slices <n>:   pt slices, each with its own VEGAS grid, default 24
+  // --seed <s>:     random seed of the producers, default 1
+  // --lumi <file>:  use tabulated luminosities, cached in <file>
+  // --config <cme>: 5020 (default) or 2760, the setup of the ATLAS data
+  // --calls <f>:    scale all VEGAS calls by f
+  // --read <file>:  histogram the events of <file> into results_events.txt
+  // --bins <n>:     pt bins of --read, default 48
+  std::string outfile = "events.bin", hepmcfile, lumifile, readfile;
+  size_t nevent = 1000000, nslice = 24, nbin = 48;
+  unsigned nthread = std::max(1u, std::thread::hardware_concurrency());
+  unsigned long seed = 1;
+  bool unweighted = false;
+  int config = 5020;
+  double callscale = 1.0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--events" && i + 1 < argc) {
+      nevent = static_cast<size_t>(std::stod(argv[++i]));
+    } else if (arg == "--unweighted") {
+      unweighted = true;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      nthread = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+    } else if (arg == "--out" && i + 1 < argc) {
+      outfile = argv[++i];
+    } else if (arg == "--hepmc" && i + 1 < argc) {
+      hepmcfile = argv[++i];
+    } else if (arg == "--slices" && i + 1 < argc) {
+      nslice = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+    } else if (arg == "--seed" && i + 1 < argc) {
+      seed = std::stoul(argv[++i]);
+    } else if (arg == "--lumi" && i + 1 < argc) {
+      lumifile = argv[++i];
+    } else if (arg == "--config" && i + 1 < argc) {
+      config = std::stoi(argv[++i]);
+    } else if (arg == "--calls" && i + 1 < argc) {
+      callscale = std::stod(argv[++i]);
+    } else if (arg == "--read" && i + 1 < argc) {
+      readfile = argv[++i];
+    } else if (arg == "--bins" && i + 1 < argc) {
+      nbin = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--events <n>] [--unweighted] [--threads <n>]"
+                   " [--out <file>] [--hepmc <file>] [--slices <n>]"
+                   " [--seed <s>] [--lumi <file>] [--config 5020|2760]"
+                   " [--calls <f>]\n       "
+                << argv[0] << " --read <file> [--bins <n>]" << std::endl;
+      return 1;
+    }
+  }
+  if (!readfile.empty()) return readevents(readfile, nbin);
+  if (config != 5020 && config != 2760) {
+    std::cerr << "Error: --config must be 5020 or 2760" << std::endl;
+    return 1;
+  }
+  if (nevent == 0) return 0;
+  // start program timer
+  Timer timer;
+  // display initial message
+  std::cout << "--------------------------------------------" << std::endl
+            << "   Single Inclusive Jet Events @ LO   " << std::endl
+            << "--------------------------------------------" << std::endl;
+  // setup Monte-Carlo integration environment
+  gsl_rng_env_setup();
+  // set parameters (usually from input data file)
+  parameters<jet> p;
+  bool atlas2760 = (config == 2760);
+  p.CME = atlas2760 ? 2760.0 : 5020.0;
+  p.ptmin = atlas2760 ? 30.0 : 40.0;
+  p.ptmax = atlas2760 ? 500.0 : 1000.0;
+  p.ymin = atlas2760 ? -2.1 : -2.8;
+  p.ymax = atlas2760 ? +2.1 : +2.8;
+  p.opt.do_Qjet = true;
+  p.opt.do_Gjet = true;
+  // integration settings (usually from input data file)
+  vegascalls c;
+  c.ncall1 = static_cast<size_t>(c.ncall1 * callscale);
+  c.ncall2 = static_cast<size_t>(c.ncall2 * callscale);
+  // initialize PDF
+  string pdffile = "i2TAn2.00.pds";
+  {
+    PROFILE_ZONE("read pdf");
+    p.ct18anlo.setct11(pdffile);
+  }
+  lumitable lumi;
+  if (!lumifile.empty()) {
+    PROFILE_ZONE("lumi setup");
+    if (lumi.read(lumifile, pdffile, 1e-6, 5.0, 5000.0, 80, 80, 24)) {
+      std::cout << "Luminosity table read from " << lumifile << std::endl;
+    } else {
+      lumi.tabulate(p.ct18anlo, pdffile, 1e-6, 5.0, 5000.0, 80, 80, 24);
+      if (!lumi.write(lumifile))
+        std::cerr << "Error: unable to write " << lumifile << std::endl;
+      std::cout << "Luminosity table written to " << lumifile << std::endl;
+    }
+    p.lumi = &lumi;
+  }
+  // slices equal in ln pt, as the spectrum falls steeply: adapt the grid,
+  // then a pre-scan gives the cross section and the largest weight
+  generator g;
+  g.dy = p.ymax - p.ymin;
+  g.nevent = nevent;
+  g.unweighted = unweighted;
+  g.sigma = g.error = 0.0;
+  double ratio = p.ptmax / p.ptmin;
+  for (size_t k = 0; k < nslice; ++k) {
+    PROFILE_ZONE("slice");
+    double binL = p.ptmin * std::pow(ratio, static_cast<double>(k) / nslice);
+    double binR =
+        p.ptmin * std::pow(ratio, static_cast<double>(k + 1) / nslice);
+    double res, err;
+    vegasbin<jet> vb(p, binL, binR);
+    vb.warmup(c.ncall1, c.itm1, res, err);
+    slice s{vegasgrid(vb.s, vb.lower, vb.upper), 0.0, 0.0, 0.0, 0.0, 0.0};
+    mcsum all, allowed;
+    double dx[jet::ndim], w[nchannel];
+    phasespace ps;
+    size_t ncall = c.ncall2 * c.itm2;
+    for (size_t n = 0; n < ncall; ++n) {
+      double wgt = s.grid.sample(vb.r, dx) * g.dy;
+      double sum = 0.0;
+      if (contributions(dx, p, ps, w))
+        for (int ch = 0; ch < nchannel; ++ch) sum += w[ch];
+      all.add(wgt * sum);
+      if (wgt * sum > 0.0) {
+        allowed.add(wgt * sum);
+        s.wmax = std::max(s.wmax, wgt * sum);
+      }
+    }
+    s.sigma = all.mean();
+    s.error = all.error();
+    s.mean = allowed.mean();
+    std::cout << "Slice " << k << ": " << std::fixed << std::setprecision(1)
+              << binL << " < pt < " << binR << std::scientific
+              << std::setprecision(4) << ", sigma = " << s.sigma << " nb"
+              << std::defaultfloat << ", efficiency "
+              << (s.wmax > 0.0 ? s.mean / s.wmax : 0.0) << std::endl;
+    g.sigma += s.sigma;
+    g.error += s.error * s.error;
+    g.slices.push_back(s);
+  }
+  g.error = std::sqrt(g.error);
+  double cum = 0.0;
+  for (slice& s : g.slices) {
+    s.prob = unweighted ? s.sigma / g.sigma : 1.0 / static_cast<double>(nslice);
+    g.cdf.push_back(cum += s.prob);
+  }
+  // output files
+  eventheader head{};
+  head.unweighted = unweighted ? 1 : 0;
+  head.CME = p.CME;
+  head.ptmin = p.ptmin;
+  head.ptmax = p.ptmax;
+  head.ymin = p.ymin;
+  head.ymax = p.ymax;
+  eventwriter out;
+  if (!out.open(outfile, head)) {
+    std::cerr << "Error: unable to write " << outfile << std::endl;
+    return 1;
+  }
+  hepmcwriter hepmc;
+  if (!hepmcfile.empty() && !hepmc.open(hepmcfile, p.CME)) {
+    std::cerr << "Error: unable to write " << hepmcfile << std::endl;
+    return 1;
+  }
+  // producers, one queue each
+  Timer generation;
+  nthread = static_cast<unsigned>(std::min<size_t>(nthread, nevent));
+  std::vector<std::unique_ptr<spscqueue<event>>> queues;
+  std::vector<size_t> left(nthread);
+  std::vector<counters> cnt(nthread);
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < nthread; ++t) {
+    left[t] = nevent / nthread + (t < nevent % nthread ? 1 : 0);
+    queues.emplace_back(new spscqueue<event>(1 << 16));
+    pool.emplace_back(produce, std::cref(g), p, seed + 1 + t, left[t],
+                      std::ref(*queues[t]), std::ref(cnt[t]));
+  }
+  // writer: blocks from the queues in turn, so that the file only depends
+  // on the seed and the number of threads
+  gsl_rng* r = gsl_rng_alloc(gsl_rng_default);
+  gsl_rng_set(r, seed);
+  constexpr size_t block = 4096;
+  std::vector<event> buf(block);
+  double total = 0.0;
+  for (size_t done = 0; done < nevent;) {
+    PROFILE_ZONE("write events");
+    for (unsigned t = 0; t < nthread; ++t) {
+      size_t m = std::min(block, left[t]);
+      for (size_t got = 0; got < m;) {
+        size_t k = queues[t]->pop(buf.data() + got, m - got);
+        if (k == 0) std::this_thread::yield();
+        got += k;
+      }
+      out.write(buf.data(), m);
+      for (size_t i = 0; i < m; ++i) total += buf[i].weight;
+      if (!hepmcfile.empty())
+        for (size_t i = 0; i < m; ++i)
+          hepmc.write(buf[i], 2.0 * PI * gsl_rng_uniform(r));
+      left[t] -= m;
+      done += m;
+    }
+  }
+  for (std::thread& th : pool) th.join();
+  gsl_rng_free(r);
+  bool ok = out.close(g.sigma, g.error);
+  if (!hepmcfile.empty()) ok = hepmc.close() && ok;
+  if (!ok) {
+    std::cerr << "Error: unable to write the events" << std::endl;
+    return 1;
+  }
+  // statistics
+  size_t tried = 0, overweight = 0;
+  for (const counters& n : cnt) {
+    tried += n.tried;
+    overweight += n.overweight;
+  }
+  double elapsed = timer.elapsed(), generated = generation.elapsed();
+  std::cout << "--------------------------------------------" << std::endl
+            << std::defaultfloat << " Events: " << nevent
+            << (unweighted ? " unweighted" : " weighted") << " in " << outfile
+            << "\n"
+            << " Cross section: " << g.sigma << " +- " << g.error
+            << " nb, sum of weights " << total << " nb\n"
+            << " Efficiency: " << static_cast<double>(nevent) / tried << "\n";
+  if (unweighted)
+    std::cout << " Overweight events: " << overweight << "\n";
+  std::cout << " Elapsed time: " << elapsed << " seconds\n"
+            << " Events per minute: "
+            << 60.0 * static_cast<double>(nevent) / generated << " ("
+            << nthread << " threads)\n"
+            << "--------------------------------------------" << std::endl;
+  // time per zone, with -DPROFILE
+  Profile::report(std::cout);
+  return 0;
+}
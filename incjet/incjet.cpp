@@ -1,213 +1,112 @@
-#include <gsl/gsl_monte.h>
-#include <gsl/gsl_monte_vegas.h>
 #include <stdlib.h>
 
-#include <chrono>
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
+#include "channels.h"
+#include "checkpoint.h"
 #include "ct11pdf.h"
+#include "jetbin.h"
+#include "lumitable.h"
+#include "npdfgrid.h"
+#include "process.h"
+#include "processes.h"
+#include "resultstore.h"
+#include "vegasgrid.h"
+#include "wgtgrid.h"
+#include "../timer/timer.h"
 
-// global constants
-constexpr double PI = M_PI;             // pi from GNU, not C++ standard
-constexpr double Nc = 3.0;              // number of colors
-constexpr double Cf = 4.0 / 3.0;        // Casimir factor for quarks
-constexpr double Ca = 3.0;              // Casimir factor for gluons
-constexpr int Nf = 5;                   // number of active quark flavours
-constexpr double gev2barn = 3.8938e-4;  // GeV^-2 to barn conversion factor
-
-// amplitude function shortcuts to speed up calculations
-static inline double ampA(double n1, double n2, double d) noexcept {
-  constexpr double Cf_o_Ca = Cf / Ca;
-  return Cf_o_Ca * (n1 * n1 + n2 * n2) / (d * d);
-}
-static inline double ampB(double n, double d1, double d2) noexcept {
-  constexpr double twoCf_o_Casq = 2.0 * Cf / (Ca * Ca);
-  return ampA(n, d1, d2) + ampA(n, d2, d1) - twoCf_o_Casq * (n * n) / (d1 * d2);
-}
-static inline double ampC(double n1, double n2, double d) noexcept {
-  constexpr double Cfsq_o_Casq = (Cf * Cf) / (Ca * Ca);
-  return Cfsq_o_Casq * (n1 * n1 + n2 * n2) / (n1 * n2) - ampA(n1, n2, d);
-}
-static inline double ampD(double n1, double n2, double n3) noexcept {
-  constexpr double twoCa_o_Cf = 2.0 * Ca / Cf;
-  return twoCa_o_Cf *
-         (Ca - n1 * n2 / (n3 * n3) - n1 * n3 / (n2 * n2) - n2 * n3 / (n1 * n1));
+// integrand for the grid filling run: same as integrand<jet>, but also
+// spreads the PDF-independent part of the point with MC weight "wgt" onto
+// the grid
+double fillgrid(double* dx, parameters<jet>* p, wgtgrid& grid, size_t bin,
+                double wgt) {
+  phasespace ps;
+  if (!jet::kinematics(dx, *p, ps)) return 0.0;
+  double coef[nchannel];
+  jet::coefficients(ps, *p, coef);
+  for (int ch = 0; ch < nchannel; ++ch) coef[ch] *= ps.factor * wgt;
+  grid.fill(bin, ps.xa, ps.xb, ps.mufac * ps.mufac, coef);
+  return integrand<jet>(dx, jet::ndim, p);
 }
 
-// parameters shared between main and integrand
-struct parameters {
-  double CME;
-  double ymin, ymax;
-  double ptmin, ptmax;
-  cteqpdf ct18anlo;
-  bool do_Qjet, do_Gjet;
-};
-
-// integrand function
-double integrand(double* dx, size_t ndim, void* params) {
-  (void)(ndim);  // unused
-  auto* p = static_cast<parameters*>(params);
-  // integration follows: Rev.Mod.Phys. 59, 465 (1987), eq. (A3)
-  // particle kinematics: a(xa) + b(xb) -> c(pt,yc) + d(pt,yd)
-  // different from dijet, single inclusive jet measures only one jet "c"
-  // this means only yc should be within rapidity limit, yd can be anything
-  double xa = dx[0];
-  double yc = dx[1];
-  double pt = dx[2];
-  // transverse momentum fraction
-  double xt = 2.0 * pt / p->CME;
-  // Given xb below, solve xa when xb==1
-  double xamin = (xt * std::exp(+yc)) / (2.0 - xt * std::exp(-yc));
-  if (xa < xamin || xa > 1.0) return 0.0;
-  // Given s,t,u below, solve xb when s+t+u==0
-  double xb = (xa * xt * std::exp(-yc)) / (2.0 * xa - xt * std::exp(+yc));
-  // the range of xb is bounded by xamin, but for safety check
-  if (xb < 0.0 || xb > 1.0) return 0.0;   
-  // Mandelstam variables
-  double mans = +xa * xb * p->CME * p->CME;
-  double mant = -xa * pt * p->CME * std::exp(-yc);
-  double manu = -xb * pt * p->CME * std::exp(+yc);
-  // renormalization and factorization scales
-  // One can vary the scale by a small factor (typically between 0.5 and 2)
-  double muren = pt * 1.0;    // * 0.5, * 2.0
-  double mufac = muren;
-  // coupling constant
-  // One can use a one-loop expression or a fixed value
-  // Here we read directly from PDF
-  double alphaS = p->ct18anlo.alphas(mufac);  
-  // parton distribution functions (PDF)
-  // flavour:   bb, cb, sb, db, ub,  g,  u,  d,  s,  c,  b
-  // index(i):  -5  -4  -3  -2  -1   0   1   2   3   4   5
-  // Nf + i:     0   1   2   3   4   5   6   7   8   9   10
-  double pdfa[2 * Nf + 1] = {0.0};
-  double pdfb[2 * Nf + 1] = {0.0};
-  for (int i = -Nf; i <= +Nf; ++i) {
-    pdfa[Nf + i] = p->ct18anlo.parton(i, xa, mufac);
-    pdfb[Nf + i] = p->ct18anlo.parton(i, xb, mufac);
-  }  // off-set by +Nf
-  // matrix element calculation
-  // Rev.Mod.Phys. 59, 465 (1987)
-  // QCD and Collider Physics, Ellis, Stirling and Webber, 1996
-  double QJcs = 0.0, GJcs = 0.0;
-  double dis;  // temporary variable to store distributions per channel
-  /*
-  Here I am using a different summation scheme compared to other codes
-  consider the following: q + g -> q + g
-    a(xa) -----+~~~~~ X
-               |
-    b(xb) ~~~~~+----- Y
-  We first fix the initial PDF, which means quark carries xa, and gluon carries
-  xb. If we are measuring X(pt,yc), then we are measuring a gluon jet, with
-  t-channel amplitude. If we are measuring Y(pt,yd), then we are measuring a
-  quark jet, with t<->u exchange in amplitude. In inclusive jet measurement, we
-  measure both jets and sum both contributions. This is easily extended to
-  other, especially asymmetric observables like inclusive hadron, hadron-jet.
-  Because we know the exact flavour of the measured parton.
-  */
-  // q + q' -> q + q'
-  dis = 0.0;
-  for (int i = 1; i <= Nf; ++i) {
-    for (int j = 1; j <= Nf; ++j) {
-      if (i == j) continue;
-      dis += pdfa[Nf + i] * pdfb[Nf + j];
-      dis += pdfa[Nf + i] * pdfb[Nf - j];
-      dis += pdfa[Nf - i] * pdfb[Nf + j];
-      dis += pdfa[Nf - i] * pdfb[Nf - j];
+// main program
+int main(int argc, char* argv[]) {
+  // command line options
+  // --grid <file>: also fill interpolation grids for fast re-convolution
+  // --lumi <file>: use tabulated luminosities, cached in <file>
+  // --lumi-check:  report the accuracy of the luminosity table
+  // --aa <file>:   heavy-ion mode with nuclear PDF modification from <file>
+  // --config <cme>: 5020 (default) or 2760, the setup of the ATLAS data
+  // --calls <f>:   scale all VEGAS calls by f, e.g. 0.1 for a quick run
+  // --out <file>:  results file, default results.txt
+  // --store <file>: also write every bin to the HDF5 result store <file>
+  // --run <name>:  group of this run in the store, default run0000, ...
+  // --checkpoint <file>: save the finished bins and the VEGAS state
+  // --every <s>:   seconds between checkpoints, default 60
+  // --resume:      continue from the checkpoint
+  std::string gridfile, lumifile, npdffile, outfile = "results.txt";
+  std::string storefile, runname, ckfile;
+  bool lumicheck = false, resume = false;
+  int config = 5020;
+  double callscale = 1.0, every = 60.0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--grid" && i + 1 < argc) {
+      gridfile = argv[++i];
+    } else if (arg == "--lumi" && i + 1 < argc) {
+      lumifile = argv[++i];
+    } else if (arg == "--lumi-check") {
+      lumicheck = true;
+    } else if (arg == "--aa" && i + 1 < argc) {
+      npdffile = argv[++i];
+    } else if (arg == "--config" && i + 1 < argc) {
+      config = std::stoi(argv[++i]);
+    } else if (arg == "--calls" && i + 1 < argc) {
+      callscale = std::stod(argv[++i]);
+    } else if (arg == "--out" && i + 1 < argc) {
+      outfile = argv[++i];
+    } else if (arg == "--store" && i + 1 < argc) {
+      storefile = argv[++i];
+    } else if (arg == "--run" && i + 1 < argc) {
+      runname = argv[++i];
+    } else if (arg == "--checkpoint" && i + 1 < argc) {
+      ckfile = argv[++i];
+    } else if (arg == "--every" && i + 1 < argc) {
+      every = std::stod(argv[++i]);
+    } else if (arg == "--resume") {
+      resume = true;
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--grid <file> | --aa <file>] [--lumi <file> [--lumi-check]]"
+                   " [--config 5020|2760] [--calls <f>] [--out <file>]"
+                   " [--store <file> [--run <name>]]"
+                   " [--checkpoint <file> [--every <s>] [--resume]]"
+                << std::endl;
+      return 1;
     }
   }
-  QJcs += dis * ampA(mans, manu, mant);
-  QJcs += dis * ampA(mans, mant, manu);
-  // q + qb -> q' + qb'
-  dis = 0.0;
-  for (int i = 1; i <= Nf; ++i) {
-    dis += pdfa[Nf + i] * pdfb[Nf - i];
-    dis += pdfa[Nf - i] * pdfb[Nf + i];
-  }
-  dis *= (Nf - 1);  // sum over q' not equal to q
-  QJcs += dis * ampA(mant, manu, mans);
-  QJcs += dis * ampA(manu, mant, mans);
-  // q + q -> q + q
-  dis = 0.0;
-  for (int i = 1; i <= Nf; ++i) {
-    dis += pdfa[Nf + i] * pdfb[Nf + i];
-    dis += pdfa[Nf - i] * pdfb[Nf - i];
+  if (config != 5020 && config != 2760) {
+    std::cerr << "Error: --config must be 5020 or 2760" << std::endl;
+    return 1;
   }
-  dis *= 0.5;  // identical final state
-  QJcs += dis * ampB(mans, mant, manu);
-  QJcs += dis * ampB(mans, manu, mant);
-  // q + qb -> q + qb
-  dis = 0.0;
-  for (int i = 1; i <= Nf; ++i) {
-    dis += pdfa[Nf + i] * pdfb[Nf - i];
-    dis += pdfa[Nf - i] * pdfb[Nf + i];
+  if (!gridfile.empty() && !npdffile.empty()) {
+    std::cerr << "Error: --grid and --aa can not be combined" << std::endl;
+    return 1;
   }
-  QJcs += dis * ampB(manu, mans, mant);
-  QJcs += dis * ampB(mant, mans, manu);
-  // q + qb -> g + g
-  dis = 0.0;
-  for (int i = 1; i <= Nf; ++i) {
-    dis += pdfa[Nf + i] * pdfb[Nf - i];
-    dis += pdfa[Nf - i] * pdfb[Nf + i];
+  if (resume && ckfile.empty()) {
+    std::cerr << "Error: --resume needs --checkpoint <file>" << std::endl;
+    return 1;
   }
-  dis *= 0.5;  // identical final state
-  GJcs += dis * 6.0 * ampC(mant, manu, mans);
-  GJcs += dis * 6.0 * ampC(manu, mant, mans);
-  // g + g -> q + qb
-  dis = 0.0;
-  dis = pdfa[Nf] * pdfb[Nf];
-  dis *= Nf;  // sum over all final quark flavours
-  QJcs += dis * (27.0 / 32.0) * ampC(mant, manu, mans);
-  QJcs += dis * (27.0 / 32.0) * ampC(manu, mant, mans);
-  // g + q -> g + q
-  dis = 0.0;
-  for (int i = 1; i <= Nf; ++i) {
-    dis += pdfa[Nf] * pdfb[Nf + i];
-    dis += pdfa[Nf] * pdfb[Nf - i];
-  }
-  GJcs += dis * (-9.0 / 4.0) * ampC(mans, manu, mant);
-  QJcs += dis * (-9.0 / 4.0) * ampC(mans, mant, manu);
-  // q + g -> q + g
-  dis = 0.0;
-  for (int i = 1; i <= Nf; ++i) {
-    dis += pdfa[Nf + i] * pdfb[Nf];
-    dis += pdfa[Nf - i] * pdfb[Nf];
-  }
-  QJcs += dis * (-9.0 / 4.0) * ampC(mans, manu, mant);
-  GJcs += dis * (-9.0 / 4.0) * ampC(mans, mant, manu);
-  // g + g -> g + g
-  dis = 0.0;
-  dis = pdfa[Nf] * pdfb[Nf];
-  dis *= 0.5;  // identical final state
-  GJcs += dis * ampD(mans, mant, manu);
-  GJcs += dis * ampD(mans, manu, mant);
-  // combine quark and gluon jet contributions
-  double total_amp_sq = (p->do_Qjet ? QJcs : 0.0) + (p->do_Gjet ? GJcs : 0.0);
-  // |M|^2 to dσ/dt factor
-  double ampsq_to_dsdt = PI * alphaS * alphaS / (mans * mans);
-  // pre-factor from momentum fraction 
-  double pre_factor = 2.0 / PI * xa * xb / (2.0 * xa - xt * std::exp(+yc));
-  // Jacobian: E*d^3σ/d^3p = 1/(2*pi*pt) * d^2σ/(dpt dy)
-  double jacobian = 2.0 * PI * pt;
-  // final differential cross section
-  double diff_cs = jacobian * pre_factor * ampsq_to_dsdt * total_amp_sq;
-  // convert dsig/dpt to dsig/dpt/dy
-  double diff_rap = 1.0 / (2.0 * p->ymax);
-  // convert GeV^{-2} to nano barn
-  double gev_to_nb = gev2barn * 1e9;
-  // final integrand return value
-  return diff_cs * diff_rap * gev_to_nb;
-}
-
-// main program
-int main(int argc, char* argv[]) {
-  (void)(argc);  // unused
-  (void)(argv);  // unused
   // start program timer
-  auto start = std::chrono::high_resolution_clock::now();
+  Timer timer;
   // display initial message
   std::cout << "--------------------------------------------" << std::endl
             << "    Single Inclusive Jet Production @ LO    " << std::endl
@@ -215,96 +114,211 @@ int main(int argc, char* argv[]) {
   // setup Monte-Carlo integration environment
   gsl_rng_env_setup();
   // set parameters (usually from input data file)
-  parameters p;
-  p.CME = 5020.0;       // 2760.0, 5020.0
-  p.ptmin = 40.0;       // 30, 40
-  p.ptmax = 1000.0;      // 500, 1000
-  p.ymin = -2.8;        // -2.1, -2.8
-  p.ymax = +2.8;        // +2.1, +2.8
-  p.do_Qjet = true;
-  p.do_Gjet = true;
+  parameters<jet> p;
+  bool atlas2760 = (config == 2760);
+  p.CME = atlas2760 ? 2760.0 : 5020.0;
+  p.ptmin = atlas2760 ? 30.0 : 40.0;
+  p.ptmax = atlas2760 ? 500.0 : 1000.0;
+  p.ymin = atlas2760 ? -2.1 : -2.8;
+  p.ymax = atlas2760 ? +2.1 : +2.8;
+  p.opt.do_Qjet = true;
+  p.opt.do_Gjet = true;
   // integration settings (usually from input data file)
-  size_t ncall1 = 10000;
-  size_t itm1 = 10;
-  size_t ncall2 = 100000;
-  size_t itm2 = 1;
-  // define integration limits
-  const size_t ndim = 3;
-  double dx_lower[ndim];
-  double dx_upper[ndim];
+  vegascalls c;
+  c.ncall1 = static_cast<size_t>(c.ncall1 * callscale);
+  c.ncall2 = static_cast<size_t>(c.ncall2 * callscale);
   // define histogram bins
-  const size_t nbin = 192;  // 188, 192
-  double hmin = p.ptmin;
-  double hmax = p.ptmax;
-  double bin = (hmax - hmin) / static_cast<double>(nbin);
-  double bin_mid[nbin], results[nbin], errors[nbin];
+  const size_t nbin = atlas2760 ? 188 : 192;
+  jetspectrum spec(nbin, p.ptmin, p.ptmax, !npdffile.empty());
+  histogram& h = spec.h;
   // initialize PDF
   string pdffile = "i2TAn2.00.pds";
-  p.ct18anlo.setct11(pdffile);
-  // perform integration loop
-  for (size_t i = 0; i < nbin; ++i) {
+  {
+    PROFILE_ZONE("read pdf");
+    p.ct18anlo.setct11(pdffile);
+  }
+  // luminosity table, independent of CME and bins, so it is reused by any
+  // run with the same PDF: tau > 1e-6 and 5 < mu < 5000 GeV
+  lumitable lumi;
+  if (!lumifile.empty()) {
+    PROFILE_ZONE("lumi setup");
+    if (lumi.read(lumifile, pdffile, 1e-6, 5.0, 5000.0, 80, 80, 24)) {
+      std::cout << "Luminosity table read from " << lumifile << std::endl;
+    } else {
+      lumi.tabulate(p.ct18anlo, pdffile, 1e-6, 5.0, 5000.0, 80, 80, 24);
+      if (!lumi.write(lumifile))
+        std::cerr << "Error: unable to write " << lumifile << std::endl;
+      std::cout << "Luminosity table written to " << lumifile << std::endl;
+    }
+    if (lumicheck) lumi.check(p.ct18anlo, 1e-3, 0.8, 100000, std::cout);
+    p.lumi = &lumi;
+  }
+  // nuclear PDF modification
+  npdfgrid npdf;
+  if (!npdffile.empty()) {
+    if (!npdf.setgrid(npdffile)) return 1;
+    p.npdf = &npdf;
+  }
+  // interpolation grids: 30 x-nodes per parton, 4 mu^2-nodes per bin
+  wgtgrid grid(gridfile.empty() ? 0 : nbin, 30, 4, p.CME);
+  // result store: run configuration, then the bins as they finish
+  resultstore store;
+  if (!storefile.empty()) {
+    std::vector<double> low(nbin), high(nbin);
+    for (size_t i = 0; i < nbin; ++i) {
+      low[i] = h.low(i);
+      high[i] = h.high(i);
+    }
+    if (!store.open(storefile, runname, low, high, spec.names())) return 1;
+    store.attribute("process", std::string("jet"));
+    store.attribute("mode", std::string(p.npdf ? "aa"
+                                        : gridfile.empty() ? "pp" : "grid"));
+    store.attribute("CME", p.CME);
+    store.attribute("ptmin", p.ptmin);
+    store.attribute("ptmax", p.ptmax);
+    store.attribute("ymin", p.ymin);
+    store.attribute("ymax", p.ymax);
+    store.attribute("pdf", pdffile);
+    store.attribute("lumi", lumifile);
+    store.attribute("npdf", npdffile);
+    store.attribute("ncall1", static_cast<int64_t>(c.ncall1));
+    store.attribute("itm1", static_cast<int64_t>(c.itm1));
+    store.attribute("ncall2", static_cast<int64_t>(c.ncall2));
+    store.attribute("itm2", static_cast<int64_t>(c.itm2));
+    std::cout << "Results stored in " << storefile << ", run " << store.run()
+              << std::endl;
+  }
+  // checkpoint: everything that changes the results must be in config
+  std::ostringstream ckconfig;
+  ckconfig << std::setprecision(17) << "incjet config=" << config
+           << " calls=" << callscale << " pdf=" << pdffile
+           << " lumi=" << lumifile << " aa=" << npdffile
+           << " grid=" << gridfile;
+  checkpoint ck(ckfile, ckconfig.str(), spec.columns(), every);
+  std::string ckgrid = ckfile + ".grid";
+  if (resume) {
+    std::ifstream exists(ckfile);
+    if (!exists) {
+      std::cout << "No checkpoint in " << ckfile << ", starting afresh"
+                << std::endl;
+    } else if (!ck.load()) {
+      return 1;
+    } else if (!gridfile.empty() && ck.done > 0 && !grid.read(ckgrid)) {
+      // the finished bins lack their grid weights, so they are redone
+      std::cout << "No usable grid in " << ckgrid << ", starting afresh"
+                << std::endl;
+      ck.reset();
+    } else {
+      std::cout << "Resuming from " << ckfile << " at bin " << ck.done
+                << std::endl;
+    }
+  }
+  // the grid goes first: a grid ahead of the checkpoint is harmless, as
+  // setbin clears a bin before it is filled again
+  auto save = [&](const vegasbin<jet>* vb, double res, double err) {
+    PROFILE_ZONE("checkpoint");
+    bool ok = true;
+    if (!gridfile.empty()) {
+      std::string tmp = ckgrid + ".tmp";
+      FILE* f = std::fopen(tmp.c_str(), "wb");
+      ok = f && grid.write(f);
+      if (ok)
+        ok = replace(f, tmp, ckgrid);
+      else if (f)
+        std::fclose(f);
+    }
+    ok = ok && (vb ? ck.save(vb->s, vb->r, res, err) : ck.save());
+    if (!ok) std::cerr << "Error: unable to write " << ckfile << std::endl;
+  };
+  // bins restored from the checkpoint
+  for (size_t i = 0; i < ck.done && !storefile.empty(); ++i) {
+    double val[3], errs[3];
+    spec.values(i, val, errs);
+    store.write(i, val, errs);
+  }
+  // perform integration loop; the throughput counts the calls of this
+  // process in the time of the loop, without the setup and resumed bins
+  Timer looptimer;
+  double calls = 0.0;
+  for (size_t i = ck.done; i < nbin; ++i) {
+    PROFILE_ZONE("bin");
     std::cout << "Working on bin: " << i << std::endl;
     // define bin parameters
-    double binL = hmin + static_cast<double>(i) * bin;
-    double binR = hmin + static_cast<double>(i + 1) * bin;
-    bin_mid[i] = (binL + binR) * 0.5;
+    double binL = h.low(i);
+    double binR = h.high(i);
     double res, err;
-    // lower limits
-    dx_lower[0] = 0.0;
-    dx_lower[1] = p.ymin;
-    dx_lower[2] = binL;
-    // upper limits
-    dx_upper[0] = 1.0;
-    dx_upper[1] = p.ymax;
-    dx_upper[2] = binR;
-    // local GSL monte rng and state
-    gsl_rng* r = gsl_rng_alloc(gsl_rng_default);
-    gsl_monte_vegas_state* s = gsl_monte_vegas_alloc(ndim);
-    gsl_monte_function gmf = {&integrand, ndim, &p};
-    gsl_monte_vegas_params vp;
-    // warmup run
-    gsl_monte_vegas_params_get(s, &vp);
-    vp.stage = 0;
-    vp.iterations = itm1;
-    gsl_monte_vegas_params_set(s, &vp);
-    gsl_monte_vegas_integrate(&gmf, dx_lower, dx_upper, ndim, ncall1, r, s,
-                              &res, &err);
-    // final run
-    gsl_monte_vegas_params_get(s, &vp);
-    vp.stage = 2;
-    vp.iterations = itm2;
-    gsl_monte_vegas_params_set(s, &vp);
-    gsl_monte_vegas_integrate(&gmf, dx_lower, dx_upper, ndim, ncall2, r, s,
-                              &res, &err);
-    // free resources
-    gsl_monte_vegas_free(s);
-    gsl_rng_free(r);
+    vegasbin<jet> vb(p, binL, binR);
+    // warmup run, or its state from the checkpoint
+    if (!ck.restore(vb.s, vb.r, res, err)) {
+      vb.warmup(c.ncall1, c.itm1, res, err);
+      calls += static_cast<double>(c.ncall1 * c.itm1);
+      if (!ckfile.empty() && ck.due()) save(&vb, res, err);
+    }
+    binresult r;
+    if (gridfile.empty()) {
+      // final run, pp and for heavy-ion runs also AA
+      r = finalstage(vb, p, c);
+    } else {
+      // grid run: sample the adapted grid, where each point's weight is known
+      // lowest momentum fraction: x >= xt * exp(-|y|) / 2, and mufac == pt
+      double ymaxabs = std::max(std::fabs(p.ymin), std::fabs(p.ymax));
+      double xlo = binL / p.CME * std::exp(-ymaxabs);
+      grid.setbin(i, binL, binR, xlo, binL * binL, binR * binR);
+      vegasgrid vg(vb.s, vb.lower, vb.upper);
+      mcsum sum;
+      double dx[jet::ndim];
+      size_t ncall = c.ncall2 * c.itm2;
+      double norm = 1.0 / (static_cast<double>(ncall) * h.bin);
+      for (size_t n = 0; n < ncall; ++n) {
+        double wgt = vg.sample(vb.r, dx);
+        sum.add(wgt * fillgrid(dx, &p, grid, i, wgt * norm));
+      }
+      r.pp = sum.mean();
+      r.pp_err = sum.error();
+    }
+    calls += static_cast<double>(c.ncall2 * c.itm2);
     // store result and error in array
-    results[i] = res / bin;  // normalize by bin width
-    errors[i] = err;
+    spec.set(i, r);
+    if (!storefile.empty()) {
+      PROFILE_ZONE("result store");
+      double val[3], errs[3];
+      spec.values(i, val, errs);
+      if (!store.write(i, val, errs))
+        std::cerr << "Error: unable to store bin " << i << std::endl;
+    }
+    ck.done = i + 1;
+    if (!ckfile.empty() && (ck.due() || ck.done == nbin)) save(nullptr, 0, 0);
   }
+  double looptime = looptimer.elapsed();
+  if (!storefile.empty()) store.finish();
   // print header
-  std::cout << "--------------------------------------------" << std::endl
-            << "#   x    \t    y    \t   error  " << std::endl;
-  // define print function
-  auto print = [nbin](std::ostream& out, const double* x, const double* y,
-                      const double* e) {
-    out << std::scientific << std::setprecision(6);
-    for (size_t i = 0; i < nbin; ++i)
-      out << x[i] << '\t' << y[i] << '\t' << e[i] << std::endl;
-  };
+  std::cout << "--------------------------------------------" << std::endl;
+  spec.header(std::cout);
   // print to console
-  print(std::cout, bin_mid, results, errors);
+  spec.print(std::cout);
   // print to file
-  std::ofstream fout("results.txt", std::ios::out);
-  print(fout, bin_mid, results, errors);
-  fout.close();
+  {
+    PROFILE_ZONE("output");
+    std::ofstream fout(outfile, std::ios::out);
+    spec.print(fout);
+  }
+  // write interpolation grids
+  if (!gridfile.empty()) {
+    PROFILE_ZONE("output");
+    if (grid.write(gridfile))
+      std::cout << "Interpolation grids written to " << gridfile << std::endl;
+    else
+      std::cerr << "Error: unable to write " << gridfile << std::endl;
+  }
   // display elapsed time
-  auto end = std::chrono::high_resolution_clock::now();
-  std::chrono::duration<double> elapsed = end - start;
+  double elapsed = timer.elapsed();
   std::cout << "--------------------------------------------" << std::endl
-            << " Elapsed time: " << std::defaultfloat << elapsed.count()
+            << " Elapsed time: " << std::defaultfloat << elapsed
             << " seconds\n"
+            << " Calls per second: "
+            << (looptime > 0.0 ? calls / looptime : 0.0) << "\n"
             << "--------------------------------------------" << std::endl;
+  // time per zone, with -DPROFILE
+  Profile::report(std::cout);
   return 0;
 }
\ No newline at end of file
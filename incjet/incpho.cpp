@@ -0,0 +1,61 @@
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ct11pdf.h"
+#include "process.h"
+#include "processes.h"
+#include "../timer/timer.h"
+
+// main program
+int main() {
+  // start program timer
+  Timer timer;
+  // display initial message
+  std::cout << "--------------------------------------------" << std::endl
+            << "     Direct Prompt Photon Production @ LO   " << std::endl
+            << "--------------------------------------------" << std::endl;
+  // setup Monte-Carlo integration environment
+  gsl_rng_env_setup();
+  // set parameters (usually from input data file)
+  parameters<photon> p;
+  p.CME = 5020.0;  // 2760.0, 5020.0
+  p.ptmin = 25.0;
+  p.ptmax = 325.0;
+  p.ymin = -1.37;
+  p.ymax = +1.37;
+  // integration settings (usually from input data file)
+  vegascalls c;
+  // define histogram bins
+  histogram h(60, p.ptmin, p.ptmax);
+  // initialize PDF
+  string pdffile = "i2TAn2.00.pds";
+  {
+    PROFILE_ZONE("read pdf");
+    p.ct18anlo.setct11(pdffile);
+  }
+  // perform integration loop
+  integrate(p, c, h);
+  // print header
+  std::cout << "--------------------------------------------" << std::endl
+            << "#   x    \t    y    \t   error  " << std::endl;
+  // print to console
+  h.print(std::cout);
+  // print to file
+  {
+    PROFILE_ZONE("output");
+    std::ofstream fout("results_photon.txt", std::ios::out);
+    h.print(fout);
+  }
+  // display elapsed time
+  double elapsed = timer.elapsed();
+  std::cout << "--------------------------------------------" << std::endl
+            << " Elapsed time: " << std::defaultfloat << elapsed
+            << " seconds\n"
+            << "--------------------------------------------" << std::endl;
+  // time per zone, with -DPROFILE
+  Profile::report(std::cout);
+  return 0;
+}
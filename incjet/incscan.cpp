@@ -0,0 +1,388 @@
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ct11pdf.h"
+#include "jetbin.h"
+#include "lumitable.h"
+#include "npdfgrid.h"
+#include "process.h"
+#include "processes.h"
+#include "resultstore.h"
+#include "runcard.h"
+#include "../timer/timer.h"
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+// Batch mode of incjet: all configurations of a run card in one process.
+// Every PDF table, luminosity table and nPDF grid is read (or tabulated)
+// once and shared by the configurations that use it. The bins of all
+// configurations are then handed out one at a time to the worker threads,
+// so a small configuration does not leave cores idle while a large one
+// runs. Every bin starts from a fresh VEGAS random-number generator, so
+// each configuration gives the same results as incjet.exe.
+// With HAVE_MPI (incscan_mpi.exe, see compile.sh) the bins are also handed
+// out to other MPI ranks, on this or other nodes, and rank 0 collects them.
+// A bin is never split, so its VEGAS estimate is the one of a single
+// process, and rank 0 writes every result once.
+
+// resources shared by all configurations; the lumi tables and nPDF grids
+// are only read by the workers, the PDFs are copied by each of them
+struct shared {
+  std::map<std::string, std::unique_ptr<cteqpdf>> pdfs;
+  std::map<std::string, std::unique_ptr<lumitable>> lumis;
+  std::map<std::string, std::unique_ptr<npdfgrid>> npdfs;
+  std::map<std::string, std::string> lumipdf;  // PDF of each lumi table
+};
+
+// read the PDFs, lumi tables and nPDF grids of all runs, false on error
+bool load(const std::vector<runconfig>& runs, shared& sh) {
+  for (const runconfig& rc : runs) {
+    if (!sh.pdfs.count(rc.pdf)) {
+      std::ifstream exists(rc.pdf);
+      if (!exists) {
+        std::cerr << "Error: unable to open PDF table " << rc.pdf << std::endl;
+        return false;
+      }
+      PROFILE_ZONE("read pdf");
+      sh.pdfs[rc.pdf].reset(new cteqpdf);
+      sh.pdfs[rc.pdf]->setct11(rc.pdf);
+      std::cout << "PDF table read from " << rc.pdf << std::endl;
+    }
+    if (!rc.lumi.empty() && !sh.lumis.count(rc.lumi)) {
+      PROFILE_ZONE("lumi setup");
+      lumitable* lumi = new lumitable;
+      sh.lumis[rc.lumi].reset(lumi);
+      sh.lumipdf[rc.lumi] = rc.pdf;
+      if (lumi->read(rc.lumi, rc.pdf, 1e-6, 5.0, 5000.0, 80, 80, 24)) {
+        std::cout << "Luminosity table read from " << rc.lumi << std::endl;
+      } else {
+        lumi->tabulate(*sh.pdfs[rc.pdf], rc.pdf, 1e-6, 5.0, 5000.0, 80, 80,
+                       24);
+        if (!lumi->write(rc.lumi))
+          std::cerr << "Error: unable to write " << rc.lumi << std::endl;
+        std::cout << "Luminosity table written to " << rc.lumi << std::endl;
+      }
+    }
+    if (!rc.lumi.empty() && sh.lumipdf[rc.lumi] != rc.pdf) {
+      std::cerr << "Error: run " << rc.name << ": " << rc.lumi
+                << " is the table of " << sh.lumipdf[rc.lumi] << std::endl;
+      return false;
+    }
+    if (!rc.aa.empty() && !sh.npdfs.count(rc.aa)) {
+      sh.npdfs[rc.aa].reset(new npdfgrid);
+      if (!sh.npdfs[rc.aa]->setgrid(rc.aa)) return false;
+    }
+  }
+  return true;
+}
+
+// one configuration: its spectrum and the bins still to do
+struct scan {
+  const runconfig* rc;
+  vegascalls c;  // scaled
+  jetspectrum spec;
+  std::atomic<size_t> left;
+  resultstore store;
+
+  explicit scan(const runconfig& r)
+      : rc(&r), spec(r.nbin, r.ptmin, r.ptmax, !r.aa.empty()), left(r.nbin) {
+    c = r.c;
+    c.ncall1 = static_cast<size_t>(c.ncall1 * r.calls);
+    c.ncall2 = static_cast<size_t>(c.ncall2 * r.calls);
+  }
+};
+
+// state of the whole batch, shared by the workers
+struct batch {
+  const shared* sh;
+  std::vector<std::unique_ptr<scan>> scans;
+  std::vector<std::pair<size_t, size_t>> units;  // (scan, bin)
+  std::atomic<size_t> next{0};
+  std::mutex lock;  // console, result store and output files
+  bool stored = false;
+  Timer run;  // since the workers started
+};
+
+// write the spectrum of a finished configuration
+void finish(batch& b, scan& s) {
+  PROFILE_ZONE("output");
+  std::ofstream fout(s.rc->out, std::ios::out);
+  s.spec.print(fout);
+  fout.close();
+  std::lock_guard<std::mutex> guard(b.lock);
+  if (b.stored) s.store.finish();
+  std::cout << "Run " << s.rc->name << " done after " << std::defaultfloat
+            << b.run.elapsed() << " seconds, results in " << s.rc->out
+            << std::endl;
+}
+
+// parameters of the worker, one per PDF table
+typedef std::map<std::string, std::unique_ptr<parameters<jet>>> workerpdfs;
+
+// bin of unit u, on the worker's own copy of the PDF
+binresult compute(const batch& b, size_t u, workerpdfs& params) {
+  PROFILE_ZONE("bin");
+  const scan& s = *b.scans[b.units[u].first];
+  size_t i = b.units[u].second;
+  const runconfig& rc = *s.rc;
+  std::unique_ptr<parameters<jet>>& pp = params[rc.pdf];
+  if (!pp) {
+    pp.reset(new parameters<jet>);
+    pp->ct18anlo = *b.sh->pdfs.at(rc.pdf);
+  }
+  parameters<jet>& p = *pp;
+  p.CME = rc.CME;
+  p.ptmin = rc.ptmin;
+  p.ptmax = rc.ptmax;
+  p.ymin = rc.ymin;
+  p.ymax = rc.ymax;
+  p.opt.do_Qjet = rc.do_Qjet;
+  p.opt.do_Gjet = rc.do_Gjet;
+  p.lumi = rc.lumi.empty() ? nullptr : b.sh->lumis.at(rc.lumi).get();
+  p.npdf = rc.aa.empty() ? nullptr : b.sh->npdfs.at(rc.aa).get();
+  // warm-up and final run, as in incjet
+  double res, err;
+  vegasbin<jet> vb(p, s.spec.h.low(i), s.spec.h.high(i));
+  vb.warmup(s.c.ncall1, s.c.itm1, res, err);
+  return finalstage(vb, p, s.c);
+}
+
+// result of unit u into its spectrum and the result store
+void record(batch& b, size_t u, const binresult& r) {
+  scan& s = *b.scans[b.units[u].first];
+  size_t i = b.units[u].second;
+  s.spec.set(i, r);
+  if (b.stored) {
+    PROFILE_ZONE("result store");
+    double val[3], errs[3];
+    s.spec.values(i, val, errs);
+    std::lock_guard<std::mutex> guard(b.lock);
+    if (!s.store.write(i, val, errs))
+      std::cerr << "Error: unable to store bin " << i << " of run "
+                << s.rc->name << std::endl;
+  }
+  // the last bin of a configuration writes its results
+  if (s.left.fetch_sub(1) == 1) finish(b, s);
+}
+
+// worker thread: takes bins until none are left
+void work(batch& b) {
+  workerpdfs params;
+  for (size_t u; (u = b.next.fetch_add(1)) < b.units.size();)
+    record(b, u, compute(b, u, params));
+}
+
+#ifdef HAVE_MPI
+// MPI: rank 0 hands out the units on request and collects their results,
+// the other ranks compute one unit at a time. Every request to rank 0
+// carries the result of the previous unit, {u, pp, ..., ratio_err} with
+// u = -1 for the first one; the reply is the next unit, or units.size()
+// when none are left. Rank 0 takes the units from the same counter as its
+// own worker threads, if any.
+constexpr int tag_result = 1, tag_unit = 2;
+constexpr int nmsg = 7;
+
+// rank 0: serve the requests until all other ranks are done
+void coordinate(batch& b, int nrank) {
+  double msg[nmsg];
+  for (int active = nrank - 1; active > 0;) {
+    MPI_Status status;
+    MPI_Recv(msg, nmsg, MPI_DOUBLE, MPI_ANY_SOURCE, tag_result,
+             MPI_COMM_WORLD, &status);
+    if (msg[0] >= 0.0) {
+      binresult r;
+      r.pp = msg[1];
+      r.pp_err = msg[2];
+      r.aa = msg[3];
+      r.aa_err = msg[4];
+      r.ratio = msg[5];
+      r.ratio_err = msg[6];
+      record(b, static_cast<size_t>(msg[0]), r);
+    }
+    unsigned long long u = b.next.fetch_add(1);
+    if (u >= b.units.size()) {
+      u = b.units.size();
+      --active;
+    }
+    MPI_Send(&u, 1, MPI_UNSIGNED_LONG_LONG, status.MPI_SOURCE, tag_unit,
+             MPI_COMM_WORLD);
+  }
+}
+
+// other ranks: compute the units given by rank 0
+void serve(const batch& b) {
+  workerpdfs params;
+  double msg[nmsg] = {-1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  for (;;) {
+    MPI_Send(msg, nmsg, MPI_DOUBLE, 0, tag_result, MPI_COMM_WORLD);
+    unsigned long long u;
+    MPI_Recv(&u, 1, MPI_UNSIGNED_LONG_LONG, 0, tag_unit, MPI_COMM_WORLD,
+             MPI_STATUS_IGNORE);
+    if (u >= b.units.size()) break;
+    binresult r = compute(b, u, params);
+    msg[0] = static_cast<double>(u);
+    msg[1] = r.pp;
+    msg[2] = r.pp_err;
+    msg[3] = r.aa;
+    msg[4] = r.aa_err;
+    msg[5] = r.ratio;
+    msg[6] = r.ratio_err;
+  }
+}
+#endif
+
+// all runs of the card, rank of nrank processes (1 without MPI)
+int batchrun(int argc, char* argv[], int rank, int nrank) {
+  // command line options
+  // <card>:         run card with the configurations, see runcard.h
+  // --threads <n>:  worker threads, default all cores; with MPI, threads
+  //                 of rank 0 besides handing out the bins, default none
+  // --store <file>: also write every bin to the HDF5 result store <file>,
+  //                 one group per run, named as in the card
+  std::string cardfile, storefile;
+  unsigned nthread = std::max(1u, std::thread::hardware_concurrency());
+  if (nrank > 1) nthread = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--threads" && i + 1 < argc) {
+      nthread = static_cast<unsigned>(std::max(0, std::stoi(argv[++i])));
+    } else if (arg == "--store" && i + 1 < argc) {
+      storefile = argv[++i];
+    } else if (cardfile.empty() && arg[0] != '-') {
+      cardfile = arg;
+    } else {
+      cardfile.clear();
+      break;
+    }
+  }
+  if (nrank == 1) nthread = std::max(1u, nthread);
+  if (cardfile.empty()) {
+    if (rank == 0)
+      std::cerr << "usage: " << argv[0]
+                << " <card> [--threads <n>] [--store <file>]" << std::endl;
+    return 1;
+  }
+  std::vector<runconfig> runs;
+  if (!readcard(cardfile, runs)) return 1;
+  // only rank 0 reports
+  if (rank > 0) std::cout.setstate(std::ios::failbit);
+  // start program timer
+  Timer timer;
+  // display initial message
+  std::cout << "--------------------------------------------" << std::endl
+            << "   Single Inclusive Jet Production @ LO     " << std::endl
+            << "     " << runs.size() << " runs of " << cardfile << std::endl
+            << "--------------------------------------------" << std::endl;
+  // setup Monte-Carlo integration environment
+  gsl_rng_env_setup();
+  // rank 0 tabulates missing lumi tables, the other ranks then read them
+  shared sh;
+  int ok = rank == 0 ? load(runs, sh) : 1;
+#ifdef HAVE_MPI
+  MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (ok && rank > 0 && !load(runs, sh)) MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
+  if (!ok) return 1;
+  // configurations, bin by bin in the order of the card
+  batch b;
+  b.sh = &sh;
+  b.stored = !storefile.empty() && rank == 0;
+  double ncall = 0.0;
+  for (const runconfig& rc : runs) {
+    b.scans.emplace_back(new scan(rc));
+    scan& s = *b.scans.back();
+    for (size_t i = 0; i < rc.nbin; ++i)
+      b.units.emplace_back(b.scans.size() - 1, i);
+    ncall += static_cast<double>(rc.nbin * (s.c.ncall1 * s.c.itm1 +
+                                            s.c.ncall2 * s.c.itm2));
+    if (!b.stored) continue;
+    std::vector<double> low(rc.nbin), high(rc.nbin);
+    for (size_t i = 0; i < rc.nbin; ++i) {
+      low[i] = s.spec.h.low(i);
+      high[i] = s.spec.h.high(i);
+    }
+    // the other ranks wait for rank 0, so a failed store stops them all
+    if (!s.store.open(storefile, rc.name, low, high, s.spec.names())) {
+#ifdef HAVE_MPI
+      MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
+      return 1;
+    }
+    s.store.attribute("process", std::string("jet"));
+    s.store.attribute("mode", std::string(rc.aa.empty() ? "pp" : "aa"));
+    s.store.attribute("CME", rc.CME);
+    s.store.attribute("ptmin", rc.ptmin);
+    s.store.attribute("ptmax", rc.ptmax);
+    s.store.attribute("ymin", rc.ymin);
+    s.store.attribute("ymax", rc.ymax);
+    s.store.attribute("pdf", rc.pdf);
+    s.store.attribute("lumi", rc.lumi);
+    s.store.attribute("npdf", rc.aa);
+    s.store.attribute("ncall1", static_cast<int64_t>(s.c.ncall1));
+    s.store.attribute("itm1", static_cast<int64_t>(s.c.itm1));
+    s.store.attribute("ncall2", static_cast<int64_t>(s.c.ncall2));
+    s.store.attribute("itm2", static_cast<int64_t>(s.c.itm2));
+  }
+  // workers
+  nthread = static_cast<unsigned>(std::min<size_t>(nthread, b.units.size()));
+  std::cout << b.units.size() << " bins on " << nthread << " threads";
+  if (nrank > 1) std::cout << " and " << nrank - 1 << " MPI ranks";
+  std::cout << std::endl;
+  double setup = timer.elapsed();
+  b.run.reset();
+#ifdef HAVE_MPI
+  if (rank > 0) {
+    serve(b);
+    return 0;
+  }
+#endif
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < nthread; ++t)
+    pool.emplace_back(work, std::ref(b));
+#ifdef HAVE_MPI
+  coordinate(b, nrank);
+#endif
+  for (std::thread& th : pool) th.join();
+  // display elapsed time; the calls per second are those of the workers,
+  // without the setup
+  double elapsed = timer.elapsed(), run = b.run.elapsed();
+  std::cout << "--------------------------------------------" << std::endl
+            << " Elapsed time: " << std::defaultfloat << elapsed
+            << " seconds, of which setup " << setup << " seconds\n"
+            << " Calls per second: " << (run > 0.0 ? ncall / run : 0.0) << " ("
+            << nthread << " threads";
+  if (nrank > 1) std::cout << ", " << nrank - 1 << " MPI ranks";
+  std::cout << ")\n"
+            << "--------------------------------------------" << std::endl;
+  // time per zone of rank 0, with -DPROFILE
+  Profile::report(std::cout);
+  return 0;
+}
+
+// main program
+int main(int argc, char* argv[]) {
+#ifdef HAVE_MPI
+  // MPI calls come from the main thread only
+  int provided, rank, nrank;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nrank);
+  int status = batchrun(argc, argv, rank, nrank);
+  MPI_Finalize();
+  return status;
+#else
+  return batchrun(argc, argv, 0, 1);
+#endif
+}
@@ -0,0 +1,144 @@
+#ifndef JETBIN_H
+#define JETBIN_H
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "channels.h"
+#include "process.h"
+#include "processes.h"
+#include "vegasgrid.h"
+
+// One pt bin of the inclusive jet spectrum after its VEGAS warm-up, and the
+// spectrum of a whole run. Shared by incjet (one configuration, bin after
+// bin) and incscan (many configurations, bins on all cores).
+
+// pp and AA (per nucleon-nucleon) weights at the same phase-space point,
+// both nuclei carry the nuclear modification of the PDF
+inline void heavyion(double* dx, parameters<jet>* p, double& pp, double& aa) {
+  pp = aa = 0.0;
+  phasespace ps;
+  PROFILE_ZONE("integrand AA");
+  if (!jet::kinematics(dx, *p, ps)) return;
+  double alphaS;
+  {
+    PROFILE_ZONE("alpha_s");
+    alphaS = p->ct18anlo.alphas(ps.mufac);
+  }
+  double pdfa[2 * Nf + 1], pdfb[2 * Nf + 1];
+  double npdfa[2 * Nf + 1], npdfb[2 * Nf + 1];
+  partons(*p, ps.xa, ps.mufac, pdfa);
+  partons(*p, ps.xb, ps.mufac, pdfb);
+  {
+    PROFILE_ZONE("nuclear pdf");
+    p->npdf->nucleon(pdfa, ps.xa, ps.mufac, npdfa);
+    p->npdf->nucleon(pdfb, ps.xb, ps.mufac, npdfb);
+  }
+  double lumi[nchannel], nlumi[nchannel], coef[nchannel];
+  jet::luminosities(pdfa, pdfb, lumi);
+  jet::luminosities(npdfa, npdfb, nlumi);
+  PROFILE_ZONE("matrix element");
+  jet::coefficients(ps, *p, coef);
+  for (channel ch : jet::channels) {
+    pp += lumi[ch] * coef[ch];
+    aa += nlumi[ch] * coef[ch];
+  }
+  double norm = ps.factor * jet::coupling(alphaS);
+  pp *= norm;
+  aa *= norm;
+}
+
+// integrals of one bin, not yet divided by the bin width
+struct binresult {
+  double pp = 0.0, pp_err = 0.0;
+  double aa = 0.0, aa_err = 0.0;        // heavy-ion runs only
+  double ratio = 0.0, ratio_err = 0.0;  // R_AA
+};
+
+// final stage of a bin on the grid adapted by the warm-up
+inline binresult finalstage(vegasbin<jet>& vb, parameters<jet>& p,
+                            const vegascalls& c) {
+  binresult r;
+  if (!p.npdf) {
+    vb.final(c.ncall2, c.itm2, r.pp, r.pp_err);
+    return r;
+  }
+  // heavy-ion run: pp and AA weights at the same points of the adapted
+  // grid, so that their statistical fluctuations cancel in the ratio
+  PROFILE_ZONE("vegas AA");
+  vegasgrid vg(vb.s, vb.lower, vb.upper);
+  mcpair sum;
+  double dx[jet::ndim];
+  size_t ncall = c.ncall2 * c.itm2;
+  for (size_t n = 0; n < ncall; ++n) {
+    double wgt = vg.sample(vb.r, dx);
+    double pp, aa;
+    heavyion(dx, &p, pp, aa);
+    sum.add(wgt * pp, wgt * aa);
+  }
+  r.pp = sum.a.mean();
+  r.pp_err = sum.a.error();
+  r.aa = sum.b.mean();
+  r.aa_err = sum.b.error();
+  r.ratio = sum.ratio();
+  r.ratio_err = sum.ratio_error();
+  return r;
+}
+
+// pt spectrum of a run, heavy-ion runs add AA and R_AA columns
+struct jetspectrum {
+  histogram h;
+  bool heavyion;
+  std::vector<double> aa_results, aa_errors, ratios, ratio_errors;
+
+  jetspectrum(size_t nbin, double lo, double hi, bool aa)
+      : h(nbin, lo, hi), heavyion(aa), aa_results(nbin), aa_errors(nbin),
+        ratios(nbin), ratio_errors(nbin) {}
+
+  void set(size_t i, const binresult& r) {
+    h.set(i, r.pp, r.pp_err);
+    aa_results[i] = r.aa / h.bin;  // normalize by bin width, like h
+    aa_errors[i] = r.aa_err;
+    ratios[i] = r.ratio;
+    ratio_errors[i] = r.ratio_err;
+  }
+  // all columns, e.g. for a checkpoint
+  std::vector<std::vector<double>*> columns() {
+    return {&h.results, &h.errors, &aa_results, &aa_errors, &ratios,
+            &ratio_errors};
+  }
+  // names and values of bin i for the result store
+  std::vector<std::string> names() const {
+    if (heavyion) return {"pp", "AA", "R_AA"};
+    return {"pp"};
+  }
+  void values(size_t i, double* val, double* err) const {
+    val[0] = h.results[i];
+    val[1] = aa_results[i];
+    val[2] = ratios[i];
+    err[0] = h.errors[i];
+    err[1] = aa_errors[i];
+    err[2] = ratio_errors[i];
+  }
+  // column header for the console
+  void header(std::ostream& out) const {
+    out << "#   x    \t    y    \t   error  ";
+    if (heavyion) out << "\t    AA   \t   error  \t   R_AA  \t   error  ";
+    out << std::endl;
+  }
+  // x, y and error columns of results.txt
+  void print(std::ostream& out) const {
+    out << std::scientific << std::setprecision(6);
+    for (size_t i = 0; i < h.nbin; ++i) {
+      out << h.bin_mid[i] << '\t' << h.results[i] << '\t' << h.errors[i];
+      if (heavyion)
+        out << '\t' << aa_results[i] << '\t' << aa_errors[i] << '\t'
+            << ratios[i] << '\t' << ratio_errors[i];
+      out << '\n';
+    }
+  }
+};
+
+#endif  // JETBIN_H
@@ -0,0 +1,20 @@
+#ifndef LAGRANGE_H
+#define LAGRANGE_H
+
+#include <cmath>
+
+// cubic Lagrange weights at node coordinate u (uniform nodes 0..n-1),
+// returns the first of the four nodes, edge stencils are used outside
+static inline int lagrange(double u, int n, double* w) noexcept {
+  int k = static_cast<int>(std::floor(u)) - 1;
+  if (k > n - 4) k = n - 4;
+  if (k < 0) k = 0;
+  double d = u - k;
+  w[0] = -(d - 1.0) * (d - 2.0) * (d - 3.0) / 6.0;
+  w[1] = d * (d - 2.0) * (d - 3.0) / 2.0;
+  w[2] = -d * (d - 1.0) * (d - 3.0) / 2.0;
+  w[3] = d * (d - 1.0) * (d - 2.0) / 6.0;
+  return k;
+}
+
+#endif  // LAGRANGE_H
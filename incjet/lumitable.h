@@ -0,0 +1,222 @@
+#ifndef LUMITABLE_H
+#define LUMITABLE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "channels.h"
+#include "lagrange.h"
+#include "../timer/timer.h"
+
+// Tabulated parton luminosities.
+// The six channel luminosities only depend on (xa, xb, mu), or equivalently
+// on tau = xa*xb, the rapidity y = ln(xa/xb)/2 and mu. None of these know
+// about the collision energy or the pt bin, so one table per PDF serves all
+// bins and all energies. The table is rectangular in
+//   (ln tau, eta = y / ymax(tau), ln mu),  with ymax(tau) = -ln(tau)/2,
+// with nodes stretched towards large x (see below), and stores tau * lumi,
+// which is smoother than lumi itself. Evaluation is a tricubic Lagrange
+// interpolation, 64 nodes for all channels at once.
+class lumitable {
+ public:
+  lumitable() = default;
+
+  // fill the table from a PDF providing parton(i, x, Q)
+  template <typename PDF>
+  void tabulate(PDF& pdf, const std::string& name, double taumin, double mumin,
+                double mumax, int ntau, int neta, int nmu) {
+    pdsname = name;
+    head = {vfun(taumin), std::log(mumin), std::log(mumax), ntau, neta, nmu};
+    table.assign(static_cast<size_t>(ntau) * neta * nmu * nchannel, 0.0);
+    double pdfa[2 * Nf + 1], pdfb[2 * Nf + 1];
+    for (int it = 0; it < ntau; ++it) {
+      double tau = taufun(head.ltaumin * (1.0 - static_cast<double>(it) / (ntau - 1)));
+      double ltau = std::log(tau);
+      for (int ie = 0; ie < neta; ++ie) {
+        double y = -0.5 * ltau * etafun(-1.0 + 2.0 * ie / (neta - 1));
+        double xa = std::sqrt(tau) * std::exp(+y);
+        double xb = std::sqrt(tau) * std::exp(-y);
+        for (int im = 0; im < nmu; ++im) {
+          double mu = std::exp(head.lmumin + (head.lmumax - head.lmumin) * im /
+                                                 (nmu - 1));
+          // PDFs vanish at (and beyond) x == 1
+          for (int i = -Nf; i <= +Nf; ++i) {
+            pdfa[Nf + i] = xa < 1.0 ? pdf.parton(i, xa, mu) : 0.0;
+            pdfb[Nf + i] = xb < 1.0 ? pdf.parton(i, xb, mu) : 0.0;
+          }
+          double* lumi = &table[index(it, ie, im)];
+          luminosities(pdfa, pdfb, lumi);
+          for (int ch = 0; ch < nchannel; ++ch) lumi[ch] *= tau;
+        }
+      }
+    }
+  }
+
+  // interpolate all channels, false if (xa, xb, mu) is outside the table
+  bool evaluate(double xa, double xb, double mu, double* lumi) const noexcept {
+    PROFILE_ZONE("lumi table");
+    double ltau = std::log(xa * xb);
+    double v = ltau - ax * (1.0 - xa * xb);
+    double lmu = std::log(mu);
+    if (v < head.ltaumin || lmu < head.lmumin || lmu > head.lmumax)
+      return false;
+    double ymax = -0.5 * ltau;
+    double eta = ymax > 0.0 ? 0.5 * std::log(xa / xb) / ymax : 0.0;
+    double wt[4], we[4], wm[4];
+    int kt = lagrange((1.0 - v / head.ltaumin) * (head.ntau - 1), head.ntau, wt);
+    int ke = lagrange(0.5 * (ufun(eta) + 1.0) * (head.neta - 1), head.neta, we);
+    int km = lagrange((lmu - head.lmumin) / (head.lmumax - head.lmumin) *
+                          (head.nmu - 1),
+                      head.nmu, wm);
+    double sum[nchannel] = {0.0};
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        double wij = wt[i] * we[j];
+        const double* node = &table[index(kt + i, ke + j, km)];
+        for (int k = 0; k < 4; ++k, node += nchannel) {
+          double w = wij * wm[k];
+          for (int ch = 0; ch < nchannel; ++ch) sum[ch] += w * node[ch];
+        }
+      }
+    }
+    double tauinv = 1.0 / (xa * xb);
+    for (int ch = 0; ch < nchannel; ++ch) lumi[ch] = sum[ch] * tauinv;
+    return true;
+  }
+
+  // compare with direct evaluation at random points xmin < xa, xb < xmax,
+  // the error of each point is relative to the sum of all channels
+  // (towards x -> 1 the luminosities vanish and relative errors grow)
+  template <typename PDF>
+  void check(PDF& pdf, double xmin, double xmax, size_t npoint,
+             std::ostream& out) const {
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    double pdfa[2 * Nf + 1], pdfb[2 * Nf + 1];
+    double direct[nchannel], interp[nchannel];
+    double maxerr = 0.0, sumerr = 0.0;
+    size_t n = 0;
+    while (n < npoint) {
+      double xa = xmin * std::exp(std::log(xmax / xmin) * uni(rng));
+      double xb = xmin * std::exp(std::log(xmax / xmin) * uni(rng));
+      double mu = std::exp(head.lmumin + (head.lmumax - head.lmumin) * uni(rng));
+      if (!evaluate(xa, xb, mu, interp)) continue;
+      for (int i = -Nf; i <= +Nf; ++i) {
+        pdfa[Nf + i] = pdf.parton(i, xa, mu);
+        pdfb[Nf + i] = pdf.parton(i, xb, mu);
+      }
+      luminosities(pdfa, pdfb, direct);
+      double norm = 0.0, diff = 0.0;
+      for (int ch = 0; ch < nchannel; ++ch) {
+        norm += std::fabs(direct[ch]);
+        diff += std::fabs(interp[ch] - direct[ch]);
+      }
+      if (norm <= 0.0) continue;
+      maxerr = std::max(maxerr, diff / norm);
+      sumerr += diff / norm;
+      ++n;
+    }
+    out << "Luminosity table check (" << npoint << " points, " << xmin
+        << " < x < " << xmax << "): mean relative error "
+        << sumerr / static_cast<double>(n) << ", max " << maxerr << std::endl;
+  }
+
+  // binary cache file: header, name of the pds file, then the table
+  bool write(const std::string& fname) const {
+    std::ofstream out(fname, std::ios::binary);
+    if (!out) return false;
+    int32_t len = static_cast<int32_t>(pdsname.size());
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+    out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+    out.write(pdsname.data(), len);
+    out.write(reinterpret_cast<const char*>(table.data()),
+              static_cast<std::streamsize>(table.size() * sizeof(double)));
+    return static_cast<bool>(out);
+  }
+  // only accepts the table that tabulate() would make with these
+  // arguments, from the same pds file; false leaves the table unchanged
+  bool read(const std::string& fname, const std::string& name, double taumin,
+            double mumin, double mumax, int ntau, int neta, int nmu) {
+    std::ifstream in(fname, std::ios::binary);
+    char m[sizeof(magic)];
+    header h;
+    int32_t len = 0;
+    if (!in.read(m, sizeof(m)) || std::memcmp(m, magic, sizeof(m)) != 0 ||
+        !in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+        !in.read(reinterpret_cast<char*>(&len), sizeof(len)))
+      return false;
+    // check the sizes before allocating, tricubic interpolation needs 4
+    // nodes in each direction
+    if (h.ntau < 4 || h.ntau > 1024 || h.neta < 4 || h.neta > 1024 ||
+        h.nmu < 4 || h.nmu > 1024 || len < 0 || len > 4096)
+      return false;
+    if (h.ntau != ntau || h.neta != neta || h.nmu != nmu ||
+        h.ltaumin != vfun(taumin) || h.lmumin != std::log(mumin) ||
+        h.lmumax != std::log(mumax))
+      return false;
+    std::string pds(static_cast<size_t>(len), ' ');
+    if (!in.read(&pds[0], len) || pds != name) return false;
+    // and that the file holds exactly the table
+    size_t n = static_cast<size_t>(ntau) * neta * nmu * nchannel;
+    std::streamoff start = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streamoff left = in.tellg() - start;
+    in.seekg(start);
+    if (static_cast<size_t>(left) != n * sizeof(double)) return false;
+    std::vector<double> t(n);
+    if (!in.read(reinterpret_cast<char*>(t.data()),
+                 static_cast<std::streamsize>(n * sizeof(double))))
+      return false;
+    head = h;
+    pdsname = pds;
+    table.swap(t);
+    return true;
+  }
+
+ private:
+  static constexpr char magic[8] = {'I', 'J', 'L', 'U', 'M', 'I', '0', '1'};
+
+  struct header {
+    double ltaumin, lmumin, lmumax;
+    int32_t ntau, neta, nmu;
+  };
+
+  header head = {0.0, 0.0, 0.0, 0, 0, 0};
+  std::string pdsname;
+  std::vector<double> table;  // [tau][eta][mu][channel]
+
+  // tau nodes are uniform in v = ln(tau) - a*(1-tau), denser towards tau -> 1
+  static constexpr double ax = 5.0;
+  static double vfun(double tau) { return std::log(tau) - ax * (1.0 - tau); }
+  static double taufun(double v) {
+    double tau = std::exp(v);
+    for (int it = 0; it < 50; ++it) {
+      double dtau = (vfun(tau) - v) / (1.0 / tau + ax);
+      tau -= dtau;
+      if (std::fabs(dtau) < 1e-15 * tau) break;
+    }
+    return tau;
+  }
+
+  // eta nodes are uniform in u, with eta = sin(pi/2 * u) dense towards the
+  // edges |eta| -> 1, where one of the partons approaches x = 1
+  static double etafun(double u) { return std::sin(0.5 * M_PI * u); }
+  static double ufun(double eta) {
+    return std::asin(std::max(-1.0, std::min(1.0, eta))) / (0.5 * M_PI);
+  }
+
+  size_t index(int it, int ie, int im) const {
+    return ((static_cast<size_t>(it) * head.neta + ie) * head.nmu + im) *
+           nchannel;
+  }
+};
+
+#endif  // LUMITABLE_H
@@ -0,0 +1,65 @@
+#ifndef NPDFGRID_H
+#define NPDFGRID_H
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "flavgrid.h"
+
+// Multiplicative nuclear modification of the proton PDF (shadowing).
+// The nucleon PDF of a nucleus (A, Z) is built from the proton PDF f_i and
+// the bound-proton ratios R_i(x, Q), with isospin symmetry for the neutrons:
+//   f_i/A = Z/A * R_i * f_i/p + (A-Z)/A * R_i' * f_i'/p,  u <-> d for i'.
+//
+// Grid file format (plain text, '#' starts a comment line):
+//   A  Z
+//   followed by the ratios as a flavgrid table, see flavgrid.h
+class npdfgrid {
+ public:
+  // nucleus mass number and charge
+  double A = 1.0, Z = 1.0;
+
+  // read the grid from file, false on error
+  bool setgrid(const std::string& fname) {
+    std::ifstream infile(fname);
+    if (!infile) {
+      std::cerr << "error: unable to open input file: " << fname << std::endl;
+      return false;
+    }
+    // strip comment lines, then read everything as numbers
+    std::stringstream data;
+    std::string aline;
+    while (std::getline(infile, aline))
+      if (aline.empty() || aline[0] != '#') data << aline << '\n';
+    data >> A >> Z;
+    if (!data || !R.read(data)) {
+      std::cerr << "Wrong in the nPDF table!" << "\n"
+                << "length not match!" << std::endl;
+      return false;
+    }
+    std::cout << "nPDF grid " << fname << " read for A = " << A
+              << ", Z = " << Z << std::endl;
+    return true;
+  }
+
+  // per-nucleon PDFs from proton PDFs, both indexed 5 + i for i = -5..5
+  void nucleon(const double* pdf, double x, double Q, double* out) const {
+    double r[flavgrid::nflav];
+    R.values(x, Q, r);
+    double zp = Z / A, zn = 1.0 - zp;
+    for (int f = 0; f < flavgrid::nflav; ++f) out[f] = r[f] * pdf[f];
+    // neutrons: u <-> d and ub <-> db
+    double u = out[6], d = out[7], ub = out[4], db = out[3];
+    out[6] = zp * u + zn * d;
+    out[7] = zp * d + zn * u;
+    out[4] = zp * ub + zn * db;
+    out[3] = zp * db + zn * ub;
+  }
+
+ private:
+  flavgrid R;  // bound-proton ratios
+};
+
+#endif  // NPDFGRID_H
@@ -0,0 +1,197 @@
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <gsl/gsl_monte.h>
+#include <gsl/gsl_monte_vegas.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "channels.h"
+#include "ct11pdf.h"
+#include "lumitable.h"
+#include "npdfgrid.h"
+#include "../timer/timer.h"
+
+// Generic LO driver for 2->2 processes, see processes.h for the processes.
+// A process is a policy class P with only static members:
+//   P::ndim                         dimension of the integral
+//   P::options                      process specific settings
+//   P::limits(p, binL, binR, lower, upper)  integration limits of a pt bin
+//   P::kinematics(dx, p, ps)        phase-space point, false if forbidden
+//   P::coupling(alphaS)             couplings in front of |M|^2
+// and, if P::factorized, the cross section is sum_ch lumi[ch] * coef[ch]:
+//   P::channels                     constexpr list of contributing channels
+//   P::luminosities(pdfa, pdfb, lumi)
+//   P::coefficients(ps, p, coef)
+//   P::tabulated                    luminosities are those of lumitable
+// otherwise the PDF-weighted |M|^2 is given directly:
+//   P::amp_sq(dx, ps, pdfa, pdfb, p)
+// The integrand, PDF layer and bin driver below are templates on P, so each
+// process gets its own copy with the matrix elements inlined, and there are
+// no virtual calls or function pointers inside the integration loop.
+
+// parameters shared between main and integrand
+template <typename P>
+struct parameters {
+  double CME;
+  double ymin, ymax;
+  double ptmin, ptmax;
+  cteqpdf ct18anlo;
+  const lumitable* lumi = nullptr;  // tabulated luminosities, if any
+  const npdfgrid* npdf = nullptr;   // nuclear modification, if any
+  typename P::options opt;          // process specific settings
+};
+
+// parton distribution functions (PDF) of all flavours, off-set by +Nf
+template <typename P>
+inline void partons(parameters<P>& p, double x, double mu, double* pdf) {
+  PROFILE_ZONE("pdf");
+  for (int i = -Nf; i <= +Nf; ++i) pdf[Nf + i] = p.ct18anlo.parton(i, x, mu);
+}
+
+// PDF-weighted |M|^2 at a phase-space point
+template <typename P>
+inline double amp_sq(const double* dx, const phasespace& ps, parameters<P>& p) {
+  double pdfa[2 * Nf + 1], pdfb[2 * Nf + 1];
+  if constexpr (P::factorized) {
+    // parton luminosities, from the table when inside its range
+    double lumi[nchannel], coef[nchannel];
+    if (!P::tabulated || !p.lumi ||
+        !p.lumi->evaluate(ps.xa, ps.xb, ps.mufac, lumi)) {
+      partons(p, ps.xa, ps.mufac, pdfa);
+      partons(p, ps.xb, ps.mufac, pdfb);
+      P::luminosities(pdfa, pdfb, lumi);
+    }
+    // sum over luminosity channels
+    PROFILE_ZONE("matrix element");
+    P::coefficients(ps, p, coef);
+    double sum = 0.0;
+    for (channel ch : P::channels) sum += lumi[ch] * coef[ch];
+    return sum;
+  } else {
+    partons(p, ps.xa, ps.mufac, pdfa);
+    partons(p, ps.xb, ps.mufac, pdfb);
+    PROFILE_ZONE("matrix element");
+    return P::amp_sq(dx, ps, pdfa, pdfb, p);
+  }
+}
+
+// integrand function
+template <typename P>
+double integrand(double* dx, size_t ndim, void* params) {
+  (void)(ndim);  // unused
+  PROFILE_ZONE("integrand");
+  auto* p = static_cast<parameters<P>*>(params);
+  phasespace ps;
+  if (!P::kinematics(dx, *p, ps)) return 0.0;
+  // coupling constant
+  // One can use a one-loop expression or a fixed value
+  // Here we read directly from PDF
+  double alphaS;
+  {
+    PROFILE_ZONE("alpha_s");
+    alphaS = p->ct18anlo.alphas(ps.mufac);
+  }
+  // final integrand return value
+  return ps.factor * P::coupling(alphaS) * amp_sq(dx, ps, *p);
+}
+
+// integration settings (usually from input data file)
+struct vegascalls {
+  size_t ncall1 = 10000;  // warm-up calls per iteration
+  size_t itm1 = 10;       // warm-up iterations
+  size_t ncall2 = 100000; // final calls per iteration
+  size_t itm2 = 1;        // final iterations
+};
+
+// GSL VEGAS integration of one pt bin
+template <typename P>
+class vegasbin {
+ public:
+  static constexpr size_t ndim = P::ndim;
+  double lower[ndim], upper[ndim];  // integration limits
+  gsl_rng* r;                       // local GSL monte rng
+  gsl_monte_vegas_state* s;         // and state
+
+  vegasbin(parameters<P>& p, double binL, double binR) {
+    P::limits(p, binL, binR, lower, upper);
+    r = gsl_rng_alloc(gsl_rng_default);
+    s = gsl_monte_vegas_alloc(ndim);
+    gmf = {&integrand<P>, ndim, &p};
+  }
+  vegasbin(const vegasbin&) = delete;
+  vegasbin& operator=(const vegasbin&) = delete;
+  ~vegasbin() {
+    gsl_monte_vegas_free(s);
+    gsl_rng_free(r);
+  }
+
+  // warm-up run, adapts the grid
+  void warmup(size_t ncall, size_t itm, double& res, double& err) {
+    stage(0, ncall, itm, res, err);
+  }
+  // final run, GSL stage 2: keeps the adapted grid and the accumulated
+  // estimates, so res and err also include the warm-up iterations
+  void final(size_t ncall, size_t itm, double& res, double& err) {
+    stage(2, ncall, itm, res, err);
+  }
+
+ private:
+  gsl_monte_function gmf;
+
+  // the integrand is a zone of its own, the rest is VEGAS bookkeeping
+  void stage(int st, size_t ncall, size_t itm, double& res, double& err) {
+    PROFILE_ZONE("vegas");
+    gsl_monte_vegas_params vp;
+    gsl_monte_vegas_params_get(s, &vp);
+    vp.stage = st;
+    vp.iterations = itm;
+    gsl_monte_vegas_params_set(s, &vp);
+    gsl_monte_vegas_integrate(&gmf, lower, upper, ndim, ncall, r, s, &res,
+                              &err);
+  }
+};
+
+// pt histogram with uniform bins
+struct histogram {
+  size_t nbin;
+  double hmin, hmax, bin;
+  std::vector<double> bin_mid, results, errors;
+
+  histogram(size_t n, double lo, double hi)
+      : nbin(n), hmin(lo), hmax(hi), bin((hi - lo) / static_cast<double>(n)),
+        bin_mid(n), results(n), errors(n) {
+    for (size_t i = 0; i < nbin; ++i) bin_mid[i] = (low(i) + high(i)) * 0.5;
+  }
+  double low(size_t i) const { return hmin + static_cast<double>(i) * bin; }
+  double high(size_t i) const { return hmin + static_cast<double>(i + 1) * bin; }
+  // store result and error of bin i
+  void set(size_t i, double res, double err) {
+    results[i] = res / bin;  // normalize by bin width
+    errors[i] = err;
+  }
+  // print x, y and error columns
+  void print(std::ostream& out) const {
+    out << std::scientific << std::setprecision(6);
+    for (size_t i = 0; i < nbin; ++i)
+      out << bin_mid[i] << '\t' << results[i] << '\t' << errors[i] << '\n';
+  }
+};
+
+// plain run: warm-up and final VEGAS stage in every bin
+template <typename P>
+void integrate(parameters<P>& p, const vegascalls& c, histogram& h) {
+  for (size_t i = 0; i < h.nbin; ++i) {
+    PROFILE_ZONE("bin");
+    std::cout << "Working on bin: " << i << std::endl;
+    vegasbin<P> vb(p, h.low(i), h.high(i));
+    double res, err;
+    vb.warmup(c.ncall1, c.itm1, res, err);
+    vb.final(c.ncall2, c.itm2, res, err);
+    h.set(i, res, err);
+  }
+}
+
+#endif  // PROCESS_H
@@ -0,0 +1,143 @@
+#ifndef PROCESSES_H
+#define PROCESSES_H
+
+#include "channels.h"
+#include "ffgrid.h"
+#include "process.h"
+
+// LO processes for the driver in process.h. All of them measure one final
+// state particle c at (pt, yc) and share the kinematics of channels.h.
+// A new process is a new policy class here plus a short main program.
+
+// limits of (xa, yc, pt) for a pt bin
+template <typename P>
+inline void ptlimits(const parameters<P>& p, double binL, double binR,
+                     double* lower, double* upper) {
+  lower[0] = 0.0;
+  lower[1] = p.ymin;
+  lower[2] = binL;
+  upper[0] = 1.0;
+  upper[1] = p.ymax;
+  upper[2] = binR;
+}
+
+// single inclusive jet: a + b -> jet + X
+struct jet {
+  static constexpr size_t ndim = 3;  // xa, yc, pt
+  struct options {
+    bool do_Qjet = true, do_Gjet = true;  // count quark / gluon jets
+  };
+  static constexpr bool factorized = true;
+  static constexpr bool tabulated = true;
+  static constexpr channel channels[] = {ch_qqp, ch_qqb, ch_qq,
+                                         ch_gq,  ch_qg,  ch_gg};
+
+  static void limits(const parameters<jet>& p, double binL, double binR,
+                     double* lower, double* upper) {
+    ptlimits(p, binL, binR, lower, upper);
+  }
+  static bool kinematics(const double* dx, const parameters<jet>& p,
+                         phasespace& ps) {
+    return ::kinematics(dx[0], dx[1], dx[2], p.CME, p.ymax, ps);
+  }
+  static double coupling(double alphaS) { return alphaS * alphaS; }
+  static void luminosities(const double* pdfa, const double* pdfb,
+                           double* lumi) {
+    ::luminosities(pdfa, pdfb, lumi);
+  }
+  static void coefficients(const phasespace& ps, const parameters<jet>& p,
+                           double* coef) {
+    ::coefficients(ps, p.opt.do_Qjet, p.opt.do_Gjet, coef);
+  }
+};
+
+// single inclusive hadron: a + b -> c + X, c -> h(z)
+struct hadron {
+  static constexpr size_t ndim = 4;  // xa, yc, pt of the hadron, z
+  struct options {
+    double zmin = 0.05;  // lower edge of most FF grids
+    ffgrid ff;           // fragmentation functions
+  };
+  static constexpr bool factorized = false;
+
+  static void limits(const parameters<hadron>& p, double binL, double binR,
+                     double* lower, double* upper) {
+    ptlimits(p, binL, binR, lower, upper);
+    lower[3] = p.opt.zmin;
+    upper[3] = 1.0;
+  }
+  // same kinematics as the jet, the measured parton c now fragments into
+  // the hadron with momentum fraction z: pt(hadron) = z * pt(parton)
+  static bool kinematics(const double* dx, const parameters<hadron>& p,
+                         phasespace& ps) {
+    return ::kinematics(dx[0], dx[1], dx[2] / dx[3], p.CME, p.ymax, ps);
+  }
+  static double coupling(double alphaS) { return alphaS * alphaS; }
+  // E_h d^3σ/d^3p_h = int dz/z^2 D(z) E_c d^3σ/d^3p_c, which becomes
+  // dσ/(dpt_h dy) = int dz/z D(z) dσ/(dpt_c dy) at pt_c = pt_h / z
+  static double amp_sq(const double* dx, const phasespace& ps,
+                       const double* pdfa, const double* pdfb,
+                       const parameters<hadron>& p) {
+    double z = dx[3];
+    // fragmentation functions of all flavours at once, same scale as PDF
+    double D[2 * Nf + 1];
+    p.opt.ff.fragments(z, ps.mufac, D);
+    return fragmented(ps, pdfa, pdfb, D) / z;
+  }
+};
+
+// direct (prompt) photon: a + b -> gamma + X, no fragmentation photons
+// q + qb -> gamma + g and the Compton process q + g -> gamma + q, where the
+// photon couples to the quark charge, so the luminosities are weighted by e_q^2
+struct photon {
+  static constexpr size_t ndim = 3;  // xa, yc, pt
+  struct options {
+    double alphaEM = 1.0 / 137.036;  // fixed QED coupling
+  };
+  static constexpr bool factorized = true;
+  static constexpr bool tabulated = false;
+  static constexpr channel channels[] = {ch_qqb, ch_gq, ch_qg};
+
+  static void limits(const parameters<photon>& p, double binL, double binR,
+                     double* lower, double* upper) {
+    ptlimits(p, binL, binR, lower, upper);
+  }
+  static bool kinematics(const double* dx, const parameters<photon>& p,
+                         phasespace& ps) {
+    return ::kinematics(dx[0], dx[1], dx[2], p.CME, p.ymax, ps);
+  }
+  // alpha_EM is folded into the coefficients
+  static double coupling(double alphaS) { return alphaS; }
+  // charge-weighted luminosities, same indexing as channels.h
+  static void luminosities(const double* pdfa, const double* pdfb,
+                           double* lumi) {
+    // quark charges squared: u, d, s, c, b
+    constexpr double eq2[Nf] = {4.0 / 9.0, 1.0 / 9.0, 1.0 / 9.0, 4.0 / 9.0,
+                                1.0 / 9.0};
+    double qqb = 0.0, qa = 0.0, qb = 0.0;
+    for (int i = 1; i <= Nf; ++i) {
+      double e2 = eq2[i - 1];
+      qqb += e2 * (pdfa[Nf + i] * pdfb[Nf - i] + pdfa[Nf - i] * pdfb[Nf + i]);
+      qa += e2 * (pdfa[Nf + i] + pdfa[Nf - i]);
+      qb += e2 * (pdfb[Nf + i] + pdfb[Nf - i]);
+    }
+    lumi[ch_qqb] = qqb;
+    lumi[ch_gq] = pdfa[Nf] * qb;
+    lumi[ch_qg] = qa * pdfb[Nf];
+  }
+  // QCD and Collider Physics, Ellis, Stirling and Webber, 1996
+  // the photon is c, t = (pa - pc)^2
+  static void coefficients(const phasespace& ps, const parameters<photon>& p,
+                           double* coef) {
+    double s = ps.mans, t = ps.mant, u = ps.manu;
+    double a = p.opt.alphaEM;
+    // q + qb -> gamma + g
+    coef[ch_qqb] = a * (8.0 / 9.0) * (t / u + u / t);
+    // g + q -> gamma + q
+    coef[ch_gq] = a * (-1.0 / 3.0) * (s / u + u / s);
+    // q + g -> gamma + q
+    coef[ch_qg] = a * (-1.0 / 3.0) * (s / t + t / s);
+  }
+};
+
+#endif  // PROCESSES_H
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Regression gate: compares a new incjet spectrum with a reference one,
+// bin by bin, and optionally the throughput with a recorded baseline.
+// Physics: the pull of bin i is (new - ref) / sqrt(s_new^2 + s_ref^2); the
+// spectra agree if the chi^2 = sum of pulls^2 is likely for ndf = nbin
+// (p-value), no single pull is too large, and the mean pull shows no
+// common shift. Throughput: calls per second must not drop more than the
+// tolerance below the baseline recorded for the same key, e.g. the calls
+// setting, since the rate depends on it. The exit code is 0 if all checks
+// pass.
+
+// one results file: bin centre, value and error columns
+struct spectrum {
+  std::vector<double> x, y, err;
+  bool read(const std::string& file) {
+    std::ifstream in(file);
+    if (!in) return false;
+    double a, b, c;
+    while (in >> a >> b >> c) {
+      x.push_back(a);
+      y.push_back(b);
+      err.push_back(c);
+    }
+    return !x.empty();
+  }
+  // the error column is that of the bin integral, the value column is
+  // divided by the bin width (see histogram::set)
+  double sigma(size_t i) const {
+    double width = (x.size() > 1) ? (x.back() - x.front()) / (x.size() - 1)
+                                  : 1.0;
+    return err[i] / width;
+  }
+};
+
+// upper regularized incomplete gamma function Q(a, x), so that the chi^2
+// p-value is Q(ndf/2, chi2/2)
+double gammaq(double a, double x) {
+  if (x <= 0.0) return 1.0;
+  double lg = std::lgamma(a);
+  if (x < a + 1.0) {
+    // series for P(a, x)
+    double ap = a, sum = 1.0 / a, del = sum;
+    for (int n = 0; n < 1000; ++n) {
+      del *= x / ++ap;
+      sum += del;
+      if (std::fabs(del) < std::fabs(sum) * 1e-15) break;
+    }
+    return 1.0 - sum * std::exp(-x + a * std::log(x) - lg);
+  }
+  // continued fraction for Q(a, x), modified Lentz
+  double b = x + 1.0 - a, c = 1.0 / 1e-300, d = 1.0 / b, h = d;
+  for (int i = 1; i < 1000; ++i) {
+    double an = -i * (i - a);
+    b += 2.0;
+    d = an * d + b;
+    if (std::fabs(d) < 1e-300) d = 1e-300;
+    c = b + an / c;
+    if (std::fabs(c) < 1e-300) c = 1e-300;
+    d = 1.0 / d;
+    double del = d * c;
+    h *= del;
+    if (std::fabs(del - 1.0) < 1e-15) break;
+  }
+  return std::exp(-x + a * std::log(x) - lg) * h;
+}
+
+// main function
+int main(int argc, char* argv[]) {
+  // command line: reference new [options]
+  // --pvalue <p>:     smallest accepted chi^2 p-value, default 1e-3
+  // --maxpull <m>:    largest accepted |pull|, default 5
+  // --maxmean <m>:    largest accepted |mean pull|, default 4/sqrt(nbin)
+  // --rate <r>:       measured calls per second of the new run
+  // --baseline <f>:   file with the baseline calls per second, one
+  //                   "rate key" line per key; a missing key is recorded
+  // --key <k>:        baseline of this run setting, default "default"
+  // --tolerance <t>:  accepted relative drop of the rate, default 0.2
+  // --record:         overwrite the baseline of the key with --rate
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0]
+              << " reference new [--pvalue p] [--maxpull m] [--maxmean m]"
+                 " [--rate r --baseline file [--key k] [--tolerance t]"
+                 " [--record]]"
+              << std::endl;
+    return 2;
+  }
+  std::string reffile = argv[1], newfile = argv[2], basefile;
+  std::string key = "default";
+  double minp = 1e-3, maxpull = 5.0, maxmean = 0.0, rate = 0.0;
+  double tolerance = 0.2;
+  bool record = false;
+  for (int i = 3; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--pvalue" && i + 1 < argc) {
+      minp = std::stod(argv[++i]);
+    } else if (arg == "--maxpull" && i + 1 < argc) {
+      maxpull = std::stod(argv[++i]);
+    } else if (arg == "--maxmean" && i + 1 < argc) {
+      maxmean = std::stod(argv[++i]);
+    } else if (arg == "--rate" && i + 1 < argc) {
+      rate = std::stod(argv[++i]);
+    } else if (arg == "--baseline" && i + 1 < argc) {
+      basefile = argv[++i];
+    } else if (arg == "--key" && i + 1 < argc) {
+      key = argv[++i];
+    } else if (arg == "--tolerance" && i + 1 < argc) {
+      tolerance = std::stod(argv[++i]);
+    } else if (arg == "--record") {
+      record = true;
+    } else {
+      std::cerr << "Error: unknown option " << arg << std::endl;
+      return 2;
+    }
+  }
+  spectrum ref, cur;
+  if (!ref.read(reffile) || !cur.read(newfile)) {
+    std::cerr << "Error: unable to read " << reffile << " or " << newfile
+              << std::endl;
+    return 2;
+  }
+  if (ref.x.size() != cur.x.size()) {
+    std::cerr << "Error: " << ref.x.size() << " reference bins, but "
+              << cur.x.size() << " new bins" << std::endl;
+    return 1;
+  }
+  bool pass = true;
+  // physics: pulls and chi^2
+  size_t nbin = ref.x.size(), worst = 0;
+  std::vector<double> pull(nbin);
+  double chi2 = 0.0, mean = 0.0, rms = 0.0;
+  for (size_t i = 0; i < nbin; ++i) {
+    if (std::fabs(ref.x[i] - cur.x[i]) > 1e-6 * std::fabs(ref.x[i])) {
+      std::cerr << "Error: bin " << i << " is at " << cur.x[i]
+                << ", reference at " << ref.x[i] << std::endl;
+      return 1;
+    }
+    double s1 = ref.sigma(i), s2 = cur.sigma(i);
+    double sigma = std::sqrt(s1 * s1 + s2 * s2);
+    pull[i] = (sigma > 0.0) ? (cur.y[i] - ref.y[i]) / sigma
+                            : (cur.y[i] == ref.y[i] ? 0.0 : INFINITY);
+    chi2 += pull[i] * pull[i];
+    mean += pull[i] / nbin;
+    if (std::fabs(pull[i]) > std::fabs(pull[worst])) worst = i;
+  }
+  for (double q : pull) rms += (q - mean) * (q - mean) / nbin;
+  rms = std::sqrt(rms);
+  double pvalue = gammaq(0.5 * nbin, 0.5 * chi2);
+  // by default, a common shift of all bins by more than 4 sigma of the mean
+  if (maxmean <= 0.0) maxmean = 4.0 / std::sqrt(static_cast<double>(nbin));
+  std::cout << std::setprecision(4)
+            << "bins:          " << nbin << std::endl
+            << "chi2/ndf:      " << chi2 << " / " << nbin << " = "
+            << chi2 / nbin << ", p-value " << pvalue << std::endl
+            << "pulls:         mean " << mean << ", rms " << rms << std::endl
+            << "largest pull:  " << pull[worst] << " at pt = "
+            << ref.x[worst] << std::endl;
+  if (pvalue < minp) {
+    std::cout << "FAIL: chi2 p-value below " << minp << std::endl;
+    pass = false;
+  }
+  if (std::fabs(pull[worst]) > maxpull) {
+    std::cout << "FAIL: |pull| above " << maxpull << std::endl;
+    pass = false;
+  }
+  if (std::fabs(mean) > maxmean) {
+    std::cout << "FAIL: mean pull beyond " << maxmean << std::endl;
+    pass = false;
+  }
+  // throughput against the baseline of the same key
+  if (rate > 0.0 && !basefile.empty()) {
+    double baseline = 0.0;
+    std::vector<std::string> lines;  // baselines of the other keys
+    {
+      std::ifstream in(basefile);
+      std::string aline;
+      while (std::getline(in, aline)) {
+        std::istringstream ls(aline);
+        double r;
+        std::string k;
+        if (!(ls >> r)) continue;
+        std::getline(ls >> std::ws, k);
+        if (k == key)
+          baseline = r;
+        else
+          lines.push_back(aline);
+      }
+    }
+    if (!record && baseline > 0.0) {
+      std::cout << "calls/s:       " << rate << ", baseline " << baseline
+                << " (" << std::showpos << 100.0 * (rate / baseline - 1.0)
+                << std::noshowpos << "%)" << std::endl;
+      if (rate < (1.0 - tolerance) * baseline) {
+        std::cout << "FAIL: throughput more than " << 100.0 * tolerance
+                  << "% below the baseline" << std::endl;
+        pass = false;
+      }
+    } else {
+      std::ofstream out(basefile);
+      for (const std::string& l : lines) out << l << std::endl;
+      out << std::setprecision(10) << rate << " " << key << std::endl;
+      std::cout << "calls/s:       " << rate << ", recorded as baseline of "
+                << key << " in " << basefile << std::endl;
+    }
+  }
+  std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# ==========================================
+# Regression gate against the reference spectrum reference_2760.txt
+# ==========================================
+# usage: ./regress.sh [calls-factor] [extra incjet options]
+# The reference is the 2760 GeV setup. A calls factor below 1 gives a
+# quicker run with larger errors, which the pulls take into account.
+# Fails (exit code 1) if the spectrum is incompatible with the reference
+# or the calls per second drop more than 20% below regress_rate.txt.
+# The rate is that of the bin loop, and its baseline is kept per calls
+# factor and incjet options, recorded by the first run of that setting on
+# a machine. Further options of regress.exe can be given in REGRESS_OPTS,
+# e.g. "--record".
+FACTOR="${1:-0.1}"
+shift || true
+
+for f in incjet.exe regress.exe reference_2760.txt; do
+    if [[ ! -f "$f" ]]; then
+        echo "Error: $f missing, run ./compile.sh first."
+        exit 2
+    fi
+done
+
+./incjet.exe --config 2760 --calls "$FACTOR" --out regress_results.txt "$@" \
+    | tee regress.log
+RATE=$(sed -n 's/^ Calls per second: //p' regress.log)
+
+echo "--------------------------------------------"
+./regress.exe reference_2760.txt regress_results.txt \
+    --rate "$RATE" --baseline regress_rate.txt --key "calls=$FACTOR${*:+ $*}" \
+    ${REGRESS_OPTS:-}
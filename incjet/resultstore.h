@@ -0,0 +1,216 @@
+#ifndef RESULTSTORE_H
+#define RESULTSTORE_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_HDF5
+#include <hdf5.h>
+
+#include <cmath>
+#include <cstdio>
+#endif
+
+// Result store: every run becomes one HDF5 group in a shared file, with the
+// run configuration as attributes and the bins written as soon as they are
+// done, so a scan over many configurations ends up in one file.
+// Group layout:
+//   attributes        CME, ymin, ymax, pdf, calls, ... and complete (0/1)
+//   low, high         bin edges, [nbin]
+//   value, error      results and errors, [nbin][ncolumn], NaN until done,
+//                     with the column names in the attribute "columns"
+// The [nbin][ncolumn] datasets are chunked by bins and compressed, so bins
+// are written independently and partial runs can be read back.
+// Without HAVE_HDF5 (see compile.sh) opening a store fails with a message.
+class resultstore {
+ public:
+  resultstore() = default;
+  resultstore(const resultstore&) = delete;
+  resultstore& operator=(const resultstore&) = delete;
+  ~resultstore() { close(); }
+
+#ifdef HAVE_HDF5
+  // open or create fname, with a new group run (run0000, run0001, ... if
+  // empty) for nbin bins of the given columns; an existing run of the same
+  // name and shape is continued
+  bool open(const std::string& fname, std::string run,
+            const std::vector<double>& low, const std::vector<double>& high,
+            const std::vector<std::string>& columns) {
+    H5Eset_auto(H5E_DEFAULT, nullptr, nullptr);  // failures are reported here
+    nbin = low.size();
+    ncol = columns.size();
+    file = H5Fopen(fname.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+    if (file < 0)
+      file = H5Fcreate(fname.c_str(), H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+    if (file < 0) return fail("unable to open " + fname);
+    if (run.empty()) {
+      H5G_info_t info;
+      H5Gget_info(file, &info);
+      for (hsize_t n = info.nlinks;; ++n) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "run%04llu",
+                      static_cast<unsigned long long>(n));
+        if (H5Lexists(file, name, H5P_DEFAULT) <= 0) {
+          run = name;
+          break;
+        }
+      }
+    }
+    name = run;
+    if (H5Lexists(file, run.c_str(), H5P_DEFAULT) > 0) return reopen();
+    group = H5Gcreate2(file, run.c_str(), H5P_DEFAULT, H5P_DEFAULT,
+                       H5P_DEFAULT);
+    if (group < 0) return fail("unable to create run " + run);
+    // bin edges
+    hsize_t n1[1] = {nbin};
+    hid_t space = H5Screate_simple(1, n1, nullptr);
+    for (const char* edge : {"low", "high"}) {
+      hid_t set = H5Dcreate2(group, edge, H5T_NATIVE_DOUBLE, space,
+                             H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      H5Dwrite(set, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+               (edge[0] == 'l' ? low : high).data());
+      H5Dclose(set);
+    }
+    H5Sclose(space);
+    // results, chunks of up to 16 bins, deflated if zlib is available
+    hsize_t n2[2] = {nbin, ncol};
+    hsize_t chunk[2] = {nbin < 16 ? nbin : 16, ncol};
+    double nan = NAN;
+    space = H5Screate_simple(2, n2, nullptr);
+    hid_t plist = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(plist, 2, chunk);
+    H5Pset_fill_value(plist, H5T_NATIVE_DOUBLE, &nan);
+    if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0) {
+      H5Pset_shuffle(plist);
+      H5Pset_deflate(plist, 6);
+    }
+    value = H5Dcreate2(group, "value", H5T_NATIVE_DOUBLE, space, H5P_DEFAULT,
+                       plist, H5P_DEFAULT);
+    error = H5Dcreate2(group, "error", H5T_NATIVE_DOUBLE, space, H5P_DEFAULT,
+                       plist, H5P_DEFAULT);
+    H5Pclose(plist);
+    H5Sclose(space);
+    if (value < 0 || error < 0) return fail("unable to create datasets");
+    // column names as one string attribute on value and error
+    std::string names;
+    for (const std::string& c : columns)
+      names += (names.empty() ? "" : ",") + c;
+    attribute(value, "columns", names);
+    attribute(error, "columns", names);
+    attribute("complete", int64_t(0));
+    return true;
+  }
+
+  // run configuration
+  void attribute(const std::string& key, double v) {
+    attribute(group, key, H5T_NATIVE_DOUBLE, &v);
+  }
+  void attribute(const std::string& key, int64_t v) {
+    attribute(group, key, H5T_NATIVE_INT64, &v);
+  }
+  void attribute(const std::string& key, const std::string& v) {
+    attribute(group, key, v);
+  }
+
+  // results and errors of bin i, one per column
+  bool write(size_t i, const double* val, const double* err) {
+    if (value < 0) return false;
+    hsize_t start[2] = {i, 0}, count[2] = {1, ncol};
+    hid_t mem = H5Screate_simple(2, count, nullptr);
+    bool ok = true;
+    for (hid_t set : {value, error}) {
+      hid_t space = H5Dget_space(set);
+      H5Sselect_hyperslab(space, H5S_SELECT_SET, start, nullptr, count,
+                          nullptr);
+      ok = H5Dwrite(set, H5T_NATIVE_DOUBLE, mem, space, H5P_DEFAULT,
+                    set == value ? val : err) >= 0 && ok;
+      H5Sclose(space);
+    }
+    H5Sclose(mem);
+    // on disk per bin, a killed run keeps its finished bins
+    H5Fflush(file, H5F_SCOPE_LOCAL);
+    return ok;
+  }
+
+  // mark the run as complete and close the file
+  void finish() {
+    if (group >= 0) attribute("complete", int64_t(1));
+    close();
+  }
+
+  const std::string& run() const { return name; }
+
+ private:
+  hid_t file = -1, group = -1, value = -1, error = -1;
+  hsize_t nbin = 0, ncol = 0;
+  std::string name;
+
+  // continue an existing run of the same shape, e.g. a resumed one
+  bool reopen() {
+    group = H5Gopen2(file, name.c_str(), H5P_DEFAULT);
+    if (group < 0) return fail("unable to open run " + name);
+    value = H5Dopen2(group, "value", H5P_DEFAULT);
+    error = H5Dopen2(group, "error", H5P_DEFAULT);
+    if (value < 0 || error < 0) return fail("run " + name + " has no results");
+    hsize_t dims[2] = {0, 0};
+    hid_t space = H5Dget_space(value);
+    int rank = H5Sget_simple_extent_dims(space, dims, nullptr);
+    H5Sclose(space);
+    if (rank != 2 || dims[0] != nbin || dims[1] != ncol)
+      return fail("run " + name + " has other bins or columns");
+    attribute("complete", int64_t(0));
+    return true;
+  }
+  bool fail(const std::string& msg) {
+    std::cerr << "Error: result store: " << msg << std::endl;
+    close();
+    return false;
+  }
+  void close() {
+    if (value >= 0) H5Dclose(value);
+    if (error >= 0) H5Dclose(error);
+    if (group >= 0) H5Gclose(group);
+    if (file >= 0) H5Fclose(file);
+    file = group = value = error = -1;
+  }
+  // scalar attribute, replaced if it exists
+  static void attribute(hid_t obj, const std::string& key, hid_t type,
+                        const void* v) {
+    if (H5Aexists(obj, key.c_str()) > 0) H5Adelete(obj, key.c_str());
+    hid_t space = H5Screate(H5S_SCALAR);
+    hid_t attr = H5Acreate2(obj, key.c_str(), type, space, H5P_DEFAULT,
+                            H5P_DEFAULT);
+    H5Awrite(attr, type, v);
+    H5Aclose(attr);
+    H5Sclose(space);
+  }
+  static void attribute(hid_t obj, const std::string& key,
+                        const std::string& v) {
+    hid_t type = H5Tcopy(H5T_C_S1);
+    H5Tset_size(type, v.empty() ? 1 : v.size());
+    H5Tset_strpad(type, H5T_STR_NULLPAD);
+    attribute(obj, key, type, v.c_str());
+    H5Tclose(type);
+  }
+#else
+  bool open(const std::string&, const std::string&, const std::vector<double>&,
+            const std::vector<double>&, const std::vector<std::string>&) {
+    std::cerr << "Error: result store: compiled without HDF5" << std::endl;
+    return false;
+  }
+  void attribute(const std::string&, double) {}
+  void attribute(const std::string&, int64_t) {}
+  void attribute(const std::string&, const std::string&) {}
+  bool write(size_t, const double*, const double*) { return false; }
+  void finish() {}
+  const std::string& run() const { return name; }
+
+ private:
+  std::string name;
+  void close() {}
+#endif
+};
+
+#endif  // RESULTSTORE_H
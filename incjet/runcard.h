@@ -0,0 +1,119 @@
+#ifndef RUNCARD_H
+#define RUNCARD_H
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "process.h"
+
+// Run card of incscan: many configurations of the jet spectrum in one file.
+// Format (plain text, '#' starts a comment):
+//   key value ...        settings before the first run are the defaults
+//   run <name>           starts a configuration from the defaults
+//   key value ...        settings of that configuration
+// Keys:
+//   pdf <file>           CTEQ .pds table, default i2TAn2.00.pds
+//   lumi <file>          tabulated luminosities, cached in <file>
+//   aa <file>            nuclear modification, adds AA and R_AA columns
+//   cme <GeV>            collision energy, default 5020
+//   pt <min> <max> <n>   bins equal in pt, default 40 1000 192
+//   y <min> <max>        rapidity range, default -2.8 2.8
+//   jets all|quark|gluon count quark and/or gluon jets, default all
+//   calls <f>            scale all VEGAS calls by f
+//   ncall1, itm1, ncall2, itm2 <n>   VEGAS calls, see vegascalls
+//   out <file>           results, default results_<name>.txt
+struct runconfig {
+  std::string name, pdf = "i2TAn2.00.pds", lumi, aa, out;
+  double CME = 5020.0;
+  double ptmin = 40.0, ptmax = 1000.0;
+  size_t nbin = 192;
+  double ymin = -2.8, ymax = +2.8;
+  bool do_Qjet = true, do_Gjet = true;
+  double calls = 1.0;  // scale of the VEGAS calls
+  vegascalls c;        // not yet scaled
+};
+
+// read all configurations of fname, false with a message on error
+inline bool readcard(const std::string& fname, std::vector<runconfig>& runs) {
+  std::ifstream infile(fname);
+  if (!infile) {
+    std::cerr << "Error: unable to open run card " << fname << std::endl;
+    return false;
+  }
+  runs.clear();
+  runconfig defaults;
+  runconfig* cur = &defaults;
+  std::string aline;
+  for (size_t line = 1; std::getline(infile, aline); ++line) {
+    aline = aline.substr(0, aline.find('#'));
+    std::istringstream in(aline);
+    std::string key, word;
+    if (!(in >> key)) continue;
+    bool ok = true;
+    if (key == "run") {
+      ok = static_cast<bool>(in >> word);
+      runs.push_back(defaults);
+      runs.back().name = word;
+      cur = &runs.back();
+    } else if (key == "pdf") {
+      ok = static_cast<bool>(in >> cur->pdf);
+    } else if (key == "lumi") {
+      ok = static_cast<bool>(in >> cur->lumi);
+    } else if (key == "aa") {
+      ok = static_cast<bool>(in >> cur->aa);
+    } else if (key == "out") {
+      ok = static_cast<bool>(in >> cur->out);
+    } else if (key == "cme") {
+      ok = static_cast<bool>(in >> cur->CME) && cur->CME > 0.0;
+    } else if (key == "pt") {
+      ok = static_cast<bool>(in >> cur->ptmin >> cur->ptmax >> cur->nbin) &&
+           cur->ptmin > 0.0 && cur->ptmax > cur->ptmin && cur->nbin > 0;
+    } else if (key == "y") {
+      ok = static_cast<bool>(in >> cur->ymin >> cur->ymax) &&
+           cur->ymax > cur->ymin;
+    } else if (key == "jets") {
+      ok = static_cast<bool>(in >> word) &&
+           (word == "all" || word == "quark" || word == "gluon");
+      cur->do_Qjet = word != "gluon";
+      cur->do_Gjet = word != "quark";
+    } else if (key == "calls") {
+      ok = static_cast<bool>(in >> cur->calls) && cur->calls > 0.0;
+    } else if (key == "ncall1") {
+      ok = static_cast<bool>(in >> cur->c.ncall1);
+    } else if (key == "itm1") {
+      ok = static_cast<bool>(in >> cur->c.itm1);
+    } else if (key == "ncall2") {
+      ok = static_cast<bool>(in >> cur->c.ncall2);
+    } else if (key == "itm2") {
+      ok = static_cast<bool>(in >> cur->c.itm2);
+    } else {
+      std::cerr << "Error: " << fname << ":" << line << ": unknown key "
+                << key << std::endl;
+      return false;
+    }
+    if (!ok || in >> word) {
+      std::cerr << "Error: " << fname << ":" << line << ": wrong " << key
+                << " line" << std::endl;
+      return false;
+    }
+  }
+  if (runs.empty()) {
+    std::cerr << "Error: " << fname << " has no run" << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < runs.size(); ++i) {
+    for (size_t j = 0; j < i; ++j)
+      if (runs[j].name == runs[i].name) {
+        std::cerr << "Error: " << fname << ": run " << runs[i].name
+                  << " is given twice" << std::endl;
+        return false;
+      }
+    if (runs[i].out.empty()) runs[i].out = "results_" + runs[i].name + ".txt";
+  }
+  return true;
+}
+
+#endif  // RUNCARD_H
@@ -0,0 +1,53 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue between one producer and one consumer thread.
+// Only the producer writes head and only the consumer writes tail, so the
+// two sides never take a lock and only wait when the queue is full or
+// empty. Elements are moved in blocks, which keeps the atomic operations
+// and the cache line traffic between the cores off the per-element path.
+template <typename T>
+class spscqueue {
+ public:
+  // capacity is rounded up to a power of two
+  explicit spscqueue(size_t n) {
+    size_t cap = 1;
+    while (cap < n) cap <<= 1;
+    buf.resize(cap);
+    mask = cap - 1;
+  }
+  spscqueue(const spscqueue&) = delete;
+  spscqueue& operator=(const spscqueue&) = delete;
+
+  // producer: append up to n elements, returns how many fitted
+  size_t push(const T* x, size_t n) {
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t t = tail.load(std::memory_order_acquire);
+    size_t m = std::min(n, buf.size() - (h - t));
+    for (size_t i = 0; i < m; ++i) buf[(h + i) & mask] = x[i];
+    head.store(h + m, std::memory_order_release);
+    return m;
+  }
+  // consumer: take up to n elements, returns how many there were
+  size_t pop(T* x, size_t n) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    size_t m = std::min(n, h - t);
+    for (size_t i = 0; i < m; ++i) x[i] = buf[(t + i) & mask];
+    tail.store(t + m, std::memory_order_release);
+    return m;
+  }
+
+ private:
+  std::vector<T> buf;
+  size_t mask;
+  alignas(64) std::atomic<size_t> head{0};  // next slot to write
+  alignas(64) std::atomic<size_t> tail{0};  // next slot to read
+};
+
+#endif  // SPSCQUEUE_H
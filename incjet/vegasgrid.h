@@ -0,0 +1,93 @@
+#ifndef VEGASGRID_H
+#define VEGASGRID_H
+
+#include <gsl/gsl_monte_vegas.h>
+#include <gsl/gsl_rng.h>
+
+#include <cmath>
+#include <vector>
+
+// Copy of an adapted GSL VEGAS grid for plain importance sampling.
+// GSL only returns the integral, but grid filling, event generation and
+// correlated multi-weight runs need the weight of each sampled point.
+// Taking the grid out of the state after the warm-up iterations gives
+// exactly that: every point comes with its Jacobian, and the mean of
+// f(x) * weight over many points is the integral of f.
+class vegasgrid {
+ public:
+  vegasgrid(const gsl_monte_vegas_state* s, const double* xl, const double* xu)
+      : dim(s->dim), bins(s->bins), xi(s->xi, s->xi + (bins + 1) * dim),
+        lower(xl, xl + dim), width(dim) {
+    for (size_t j = 0; j < dim; ++j) width[j] = xu[j] - xl[j];
+  }
+
+  // draw one point into x, returns its weight (Jacobian)
+  double sample(const gsl_rng* r, double* x) const {
+    double weight = 1.0;
+    for (size_t j = 0; j < dim; ++j) {
+      // same grid coordinate layout as GSL: xi[i * dim + j], xi[0] == 0
+      double z = gsl_rng_uniform_pos(r) * bins;
+      size_t k = static_cast<size_t>(z);
+      if (k >= bins) k = bins - 1;
+      double lo = xi[k * dim + j];
+      double bin_width = xi[(k + 1) * dim + j] - lo;
+      x[j] = lower[j] + (lo + (z - static_cast<double>(k)) * bin_width) * width[j];
+      weight *= bins * bin_width * width[j];
+    }
+    return weight;
+  }
+
+  size_t ndim() const { return dim; }
+
+ private:
+  size_t dim;
+  size_t bins;
+  std::vector<double> xi;
+  std::vector<double> lower, width;
+};
+
+// running mean and error of weighted samples
+struct mcsum {
+  double sum = 0.0, sum2 = 0.0;
+  size_t n = 0;
+  void add(double v) {
+    sum += v;
+    sum2 += v * v;
+    ++n;
+  }
+  double mean() const { return n ? sum / static_cast<double>(n) : 0.0; }
+  double error() const {
+    if (n < 2) return 0.0;
+    double m = mean();
+    double var = (sum2 / static_cast<double>(n) - m * m);
+    return std::sqrt((var > 0.0 ? var : 0.0) / static_cast<double>(n - 1));
+  }
+};
+
+// running means of two weights sampled at the same points, with their
+// covariance, so that the error of the ratio includes the correlation
+struct mcpair {
+  mcsum a, b;
+  double sumab = 0.0;
+  void add(double va, double vb) {
+    a.add(va);
+    b.add(vb);
+    sumab += va * vb;
+  }
+  double covariance() const {
+    if (a.n < 2) return 0.0;
+    double n = static_cast<double>(a.n);
+    return (sumab / n - a.mean() * b.mean()) / (n - 1.0);
+  }
+  // ratio b/a and its error from linear error propagation
+  double ratio() const { return a.mean() != 0.0 ? b.mean() / a.mean() : 0.0; }
+  double ratio_error() const {
+    double ma = a.mean(), mb = b.mean();
+    if (ma == 0.0 || mb == 0.0) return 0.0;
+    double ea = a.error() / ma, eb = b.error() / mb;
+    double rel2 = ea * ea + eb * eb - 2.0 * covariance() / (ma * mb);
+    return std::fabs(ratio()) * std::sqrt(rel2 > 0.0 ? rel2 : 0.0);
+  }
+};
+
+#endif  // VEGASGRID_H
@@ -0,0 +1,217 @@
+#ifndef WGTGRID_H
+#define WGTGRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "channels.h"
+#include "lagrange.h"
+
+// APPLgrid/fastNLO-style interpolation weight grids.
+// At LO the cross section of each pt bin is
+//   sigma = sum_ch  int  alpha_s^2(mu) * lumi_ch(xa, xb, mu) * coef_ch
+// where coef_ch does not depend on the PDF. During one integration, every
+// weighted point is spread onto cubic Lagrange nodes in (xa, xb, mu^2), per
+// bin and channel. Any PDF (and alpha_s) can then be convoluted with the
+// stored weights without re-integrating.
+//
+// x nodes are uniform in y(x) = ln(1/x) + a*(1-x), which is dense at small x
+// and still resolves the steep fall-off near x = 1. The smoother x*f(x) is
+// what gets interpolated, so the x weights carry a factor x_node/x.
+// mu^2 nodes are uniform in ln ln(mu^2/Lambda^2) over the range of the bin.
+class wgtgrid {
+ public:
+  wgtgrid() = default;
+  wgtgrid(size_t nbin, int nx, int nq, double CME)
+      : nbin(nbin), nx(nx), nq(nq), CME(CME), bins(nbin),
+        weights(nbin * bin_size(), 0.0), xnodes(nbin * nx, 0.0) {}
+
+  // set x and mu^2 range of bin b, normalization is applied in fill()
+  void setbin(size_t b, double binL, double binR, double xlo, double q2lo,
+              double q2hi) {
+    bins[b] = {binL, binR, yfun(xlo), tfun(q2lo), tfun(q2hi)};
+    setnodes(b);
+    // a bin that is filled again (e.g. after a resume) starts empty
+    std::fill(weights.begin() + b * bin_size(),
+              weights.begin() + (b + 1) * bin_size(), 0.0);
+  }
+
+  // add weight w[ch] (without alpha_s^2 and PDFs) of one point to bin b
+  void fill(size_t b, double xa, double xb, double q2, const double* w) {
+    const binrange& r = bins[b];
+    double la[4], lb[4], lq[4];
+    int ka = lagrange(yfun(xa) / r.ymax * (nx - 1), nx, la);
+    int kb = lagrange(yfun(xb) / r.ymax * (nx - 1), nx, lb);
+    int kq = lagrange(qnode(r, tfun(q2)), nq, lq);
+    const double* xn = &xnodes[b * nx];
+    for (int i = 0; i < 4; ++i) {
+      la[i] *= xn[ka + i] / xa;
+      lb[i] *= xn[kb + i] / xb;
+    }
+    for (int ch = 0; ch < nchannel; ++ch) {
+      if (w[ch] == 0.0) continue;
+      for (int m = 0; m < 4; ++m) {
+        double wq = w[ch] * lq[m];
+        double* row = &weights[index(b, ch, kq + m, 0, 0)];
+        for (int i = 0; i < 4; ++i) {
+          double wqa = wq * la[i];
+          double* col = row + (ka + i) * nx + kb;
+          for (int j = 0; j < 4; ++j) col[j] += wqa * lb[j];
+        }
+      }
+    }
+  }
+
+  // scale all weights, e.g. by 1/ncall and 1/bin width after filling
+  void scale(size_t b, double factor) {
+    double* w = &weights[b * bin_size()];
+    for (size_t i = 0; i < bin_size(); ++i) w[i] *= factor;
+  }
+
+  // convolute with a PDF providing parton(i, x, Q) and alphas(Q), with
+  // renormalization and factorization scale factors xiR and xiF
+  template <typename PDF>
+  void convolute(PDF& pdf, double xiR, double xiF, double* out) const {
+    std::vector<double> fx(nx * (2 * Nf + 1));
+    double lumi[nchannel];
+    for (size_t b = 0; b < nbin; ++b) {
+      const binrange& r = bins[b];
+      const double* xn = &xnodes[b * nx];
+      double sum = 0.0;
+      for (int iq = 0; iq < nq; ++iq) {
+        double mu = std::sqrt(qfun(r.tlo + (r.thi - r.tlo) * iq / (nq - 1)));
+        double alphaS = pdf.alphas(xiR * mu);
+        // PDFs vanish at the x == 1 node
+        for (int i = 0; i < nx; ++i)
+          for (int k = -Nf; k <= +Nf; ++k)
+            fx[i * (2 * Nf + 1) + Nf + k] =
+                xn[i] < 1.0 ? pdf.parton(k, xn[i], xiF * mu) : 0.0;
+        double sumq = 0.0;
+        for (int ia = 0; ia < nx; ++ia) {
+          for (int ib = 0; ib < nx; ++ib) {
+            luminosities(&fx[ia * (2 * Nf + 1)], &fx[ib * (2 * Nf + 1)], lumi);
+            for (int ch = 0; ch < nchannel; ++ch)
+              sumq += weights[index(b, ch, iq, ia, ib)] * lumi[ch];
+          }
+        }
+        sum += alphaS * alphaS * sumq;
+      }
+      out[b] = sum;
+    }
+  }
+
+  // binary file: header, bin ranges, then the weights
+  bool write(const std::string& fname) const {
+    FILE* f = std::fopen(fname.c_str(), "wb");
+    if (!f) return false;
+    bool ok = write(f);
+    return (std::fclose(f) == 0) && ok;
+  }
+  // to an open file, which the caller may sync before closing it
+  bool write(FILE* f) const {
+    int32_t head[5] = {static_cast<int32_t>(nbin), nchannel, nx, nq, 0};
+    return std::fwrite(magic, sizeof(magic), 1, f) == 1 &&
+           std::fwrite(head, sizeof(head), 1, f) == 1 &&
+           std::fwrite(&CME, sizeof(CME), 1, f) == 1 &&
+           std::fwrite(bins.data(), sizeof(binrange), nbin, f) == nbin &&
+           std::fwrite(weights.data(), sizeof(double), weights.size(), f) ==
+               weights.size();
+  }
+  // false, with the grid unchanged, unless fname holds a whole grid; a
+  // grid constructed with its sizes only reads a grid of those sizes
+  bool read(const std::string& fname) {
+    std::ifstream in(fname, std::ios::binary);
+    char m[sizeof(magic)];
+    int32_t head[5];
+    double energy;
+    if (!in.read(m, sizeof(m)) || std::memcmp(m, magic, sizeof(m)) != 0 ||
+        !in.read(reinterpret_cast<char*>(head), sizeof(head)) ||
+        !in.read(reinterpret_cast<char*>(&energy), sizeof(energy)))
+      return false;
+    // check the sizes before allocating, cubic interpolation needs 4 nodes
+    if (head[0] <= 0 || head[0] > (1 << 16) || head[1] != nchannel ||
+        head[2] < 4 || head[2] > 1024 || head[3] < 4 || head[3] > 1024)
+      return false;
+    if (nbin > 0 && (static_cast<size_t>(head[0]) != nbin ||
+                     head[2] != nx || head[3] != nq || energy != CME))
+      return false;
+    // and that the file holds exactly the bin ranges and weights
+    wgtgrid g(static_cast<size_t>(head[0]), head[2], head[3], energy);
+    std::streamoff start = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streamoff left = in.tellg() - start;
+    in.seekg(start);
+    if (static_cast<size_t>(left) !=
+        g.nbin * (sizeof(binrange) + g.bin_size() * sizeof(double)))
+      return false;
+    in.read(reinterpret_cast<char*>(g.bins.data()),
+            static_cast<std::streamsize>(g.nbin * sizeof(binrange)));
+    in.read(reinterpret_cast<char*>(g.weights.data()),
+            static_cast<std::streamsize>(g.weights.size() * sizeof(double)));
+    if (!in) return false;
+    for (size_t b = 0; b < g.nbin; ++b) g.setnodes(b);
+    *this = std::move(g);
+    return true;
+  }
+
+  size_t size() const { return nbin; }
+  double energy() const { return CME; }
+  double binlow(size_t b) const { return bins[b].binL; }
+  double binhigh(size_t b) const { return bins[b].binR; }
+
+ private:
+  static constexpr char magic[8] = {'I', 'J', 'G', 'R', 'I', 'D', '0', '1'};
+  static constexpr double ax = 5.0;       // y(x) shape parameter
+  static constexpr double lambda2 = 0.0625;  // Lambda^2 in ln ln(mu^2/Lambda^2)
+
+  struct binrange {
+    double binL, binR;  // pt bin edges
+    double ymax;        // y(xlo), y(1) == 0
+    double tlo, thi;    // ln ln(mu^2/Lambda^2) range
+  };
+
+  size_t nbin = 0;
+  int nx = 0, nq = 0;
+  double CME = 0.0;
+  std::vector<binrange> bins;
+  std::vector<double> weights;  // [bin][channel][q][xa][xb]
+  std::vector<double> xnodes;   // [bin][x], not stored in the file
+
+  void setnodes(size_t b) {
+    for (int i = 0; i < nx; ++i)
+      xnodes[b * nx + i] = xfun(bins[b].ymax * i / (nx - 1));
+  }
+
+  size_t bin_size() const {
+    return static_cast<size_t>(nchannel) * nq * nx * nx;
+  }
+  size_t index(size_t b, int ch, int iq, int ia, int ib) const {
+    return (((b * nchannel + ch) * nq + iq) * nx + ia) * nx + ib;
+  }
+  double qnode(const binrange& r, double t) const {
+    return r.thi > r.tlo ? (t - r.tlo) / (r.thi - r.tlo) * (nq - 1) : 0.0;
+  }
+
+  static double yfun(double x) { return std::log(1.0 / x) + ax * (1.0 - x); }
+  static double xfun(double y) {
+    // invert y(x) with Newton iterations, starting from the small-x limit
+    double x = std::exp(-y);
+    for (int it = 0; it < 20; ++it) {
+      double dx = (yfun(x) - y) / (-1.0 / x - ax);
+      x -= dx;
+      if (std::fabs(dx) < 1e-15 * x) break;
+    }
+    return x;
+  }
+  static double tfun(double q2) { return std::log(std::log(q2 / lambda2)); }
+  static double qfun(double t) { return lambda2 * std::exp(std::exp(t)); }
+};
+
+#endif  // WGTGRID_H
@@ -0,0 +1,413 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ct11pdf.h"
+#include "process.h"
+#include "processes.h"
+
+// Python module hepkernels: batched PDF and incjet integrand calls on
+// arrays. The arrays are read and written in place through the buffer
+// protocol, so NumPy arrays (or array.array, memoryview, ...) are never
+// copied and NumPy headers are not needed to build. The loops run without
+// the GIL, optionally on several threads with one PDF copy per thread.
+//
+//   import numpy as np, hepkernels
+//   pdf = hepkernels.PDF("i2TAn2.00.pds")
+//   f = pdf.parton(flav, x, q)        # one flavour per point
+//   F = pdf.partons(x, q)             # shape (n, 11), flavours -5..5
+//   a = pdf.alphas(q)
+//   w = pdf.jet(dx, 5020.0, -2.8, 2.8)  # dx of shape (n, 3): xa, yc, pt
+// Every call takes out= for a preallocated float64 result and nthread=.
+
+namespace {
+
+// contiguous buffer of one element type, released on scope exit
+class buffer {
+ public:
+  Py_buffer view{};
+  bool ok = false;
+  buffer(PyObject* obj, bool writable) {
+    if (!obj) return;  // no array
+    int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+    if (writable) flags |= PyBUF_WRITABLE;
+    ok = PyObject_GetBuffer(obj, &view, flags) == 0;
+  }
+  buffer(const buffer&) = delete;
+  buffer& operator=(const buffer&) = delete;
+  ~buffer() {
+    if (ok) PyBuffer_Release(&view);
+  }
+  Py_ssize_t size() const { return view.len / view.itemsize; }
+  // format character without byte-order prefix
+  char type() const {
+    const char* f = view.format ? view.format : "B";
+    if (*f == '<' || *f == '=' || *f == '@' || *f == '!' || *f == '>') ++f;
+    return *f;
+  }
+  bool is_double() const { return type() == 'd' && view.itemsize == 8; }
+  bool is_int() const {
+    char t = type();
+    return t == 'i' || t == 'l' || t == 'q' || t == 'h' || t == 'b';
+  }
+  long long int_at(Py_ssize_t i) const {
+    const char* p = static_cast<const char*>(view.buf) + i * view.itemsize;
+    switch (view.itemsize) {
+      case 1: return *reinterpret_cast<const signed char*>(p);
+      case 2: return *reinterpret_cast<const short*>(p);
+      case 4: return *reinterpret_cast<const int*>(p);
+      default: return *reinterpret_cast<const long long*>(p);
+    }
+  }
+  double* doubles() const { return static_cast<double*>(view.buf); }
+};
+
+// float64 input array, or nullptr with a Python error set
+bool input(const buffer& b, const char* name) {
+  if (!b.ok) return false;
+  if (!b.is_double()) {
+    PyErr_Format(PyExc_TypeError, "%s must be a float64 array", name);
+    return false;
+  }
+  return true;
+}
+
+// output array: out if given, else a new numpy.empty(shape) (or an
+// array.array('d') without NumPy); returns a new reference
+PyObject* output(PyObject* out, Py_ssize_t n, Py_ssize_t ncol) {
+  if (out && out != Py_None) {
+    Py_INCREF(out);
+    return out;
+  }
+  // imported once, numpy or else array
+  static PyObject* np = nullptr;
+  static PyObject* arraymod = nullptr;
+  if (!np && !arraymod) {
+    np = PyImport_ImportModule("numpy");
+    if (!np) {
+      PyErr_Clear();
+      arraymod = PyImport_ImportModule("array");
+      if (!arraymod) return nullptr;
+    }
+  }
+  if (np) {
+    PyObject* shape = (ncol == 1) ? Py_BuildValue("(n)", n)
+                                  : Py_BuildValue("(nn)", n, ncol);
+    if (!shape) return nullptr;
+    PyObject* arr = PyObject_CallMethod(np, "empty", "O", shape);
+    Py_DECREF(shape);
+    return arr;
+  }
+  PyObject* zeros = PyBytes_FromStringAndSize(nullptr, n * ncol * 8);
+  if (!zeros) return nullptr;
+  std::memset(PyBytes_AS_STRING(zeros), 0, n * ncol * 8);
+  PyObject* arr = PyObject_CallMethod(arraymod, "array", "sO", "d", zeros);
+  Py_DECREF(zeros);
+  return arr;
+}
+
+// run work(pdf, first, last) over [0, n) on nthread threads, each with its
+// own PDF copy
+template <typename Work>
+void parallel(std::vector<cteqpdf>& pdfs, Py_ssize_t n, int nthread,
+              Work work) {
+  nthread = static_cast<int>(std::max<Py_ssize_t>(
+      1, std::min<Py_ssize_t>(nthread, n / 1024 + 1)));
+  while (static_cast<int>(pdfs.size()) < nthread) pdfs.push_back(pdfs[0]);
+  if (nthread == 1) {
+    work(pdfs[0], 0, n);
+    return;
+  }
+  std::vector<std::thread> pool;
+  for (int t = 0; t < nthread; ++t)
+    pool.emplace_back([&, t] {
+      work(pdfs[t], n * t / nthread, n * (t + 1) / nthread);
+    });
+  for (auto& th : pool) th.join();
+}
+
+// PDF object: the loaded table and its per-thread copies
+struct PDFObject {
+  PyObject_HEAD
+  std::vector<cteqpdf>* pdfs;
+  std::mutex* lock;  // one call at a time, the copies are shared state
+};
+
+int PDF_init(PDFObject* self, PyObject* args, PyObject*) {
+  const char* file;
+  if (!PyArg_ParseTuple(args, "s", &file)) return -1;
+  // readct11, unlike setct11, does not exit the interpreter on a bad table
+  std::vector<cteqpdf>* pdfs = new std::vector<cteqpdf>(1);
+  if (!std::ifstream(file) || !(*pdfs)[0].readct11(file)) {
+    delete pdfs;
+    PyErr_Format(PyExc_OSError, "unable to read %s", file);
+    return -1;
+  }
+  delete self->pdfs;
+  delete self->lock;
+  self->pdfs = pdfs;
+  self->lock = new std::mutex;
+  return 0;
+}
+
+void PDF_dealloc(PDFObject* self) {
+  delete self->pdfs;
+  delete self->lock;
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+bool loaded(PDFObject* self) {
+  if (self->pdfs) return true;
+  PyErr_SetString(PyExc_RuntimeError, "PDF not initialized");
+  return false;
+}
+
+bool check_out(const buffer& o, Py_ssize_t n) {
+  if (!o.ok) return false;
+  if (!o.is_double() || o.size() < n) {
+    PyErr_Format(PyExc_ValueError, "out must be a float64 array of %zd values",
+                 n);
+    return false;
+  }
+  return true;
+}
+
+// parton(flavour, x, q, out=None, nthread=1): flavour is an int or an
+// integer array of the length of x
+PyObject* PDF_parton(PDFObject* self, PyObject* args, PyObject* kwds) {
+  static const char* kw[] = {"flavour", "x", "q", "out", "nthread", nullptr};
+  PyObject *fo, *xo, *qo, *out = nullptr;
+  int nthread = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOO|Oi",
+                                   const_cast<char**>(kw), &fo, &xo, &qo,
+                                   &out, &nthread) ||
+      !loaded(self))
+    return nullptr;
+  buffer x(xo, false), q(qo, false);
+  if (!input(x, "x") || !input(q, "q")) return nullptr;
+  Py_ssize_t n = x.size();
+  if (q.size() != n) {
+    PyErr_SetString(PyExc_ValueError, "x and q differ in length");
+    return nullptr;
+  }
+  long flav = 0;
+  bool scalar = PyLong_Check(fo);
+  if (scalar) {
+    flav = PyLong_AsLong(fo);
+    if (flav == -1 && PyErr_Occurred()) return nullptr;  // OverflowError
+  }
+  buffer f(scalar ? nullptr : fo, false);
+  if (!scalar) {
+    if (!f.ok || !f.is_int() || f.size() != n) {
+      PyErr_Clear();
+      PyErr_SetString(PyExc_TypeError,
+                      "flavour must be an int or an integer array like x");
+      return nullptr;
+    }
+  }
+  PyObject* res = output(out, n, 1);
+  if (!res) return nullptr;
+  buffer o(res, true);
+  if (!check_out(o, n)) {
+    Py_DECREF(res);
+    return nullptr;
+  }
+  const double *xs = x.doubles(), *qs = q.doubles();
+  double* os = o.doubles();
+  Py_BEGIN_ALLOW_THREADS
+  std::lock_guard<std::mutex> guard(*self->lock);
+  parallel(*self->pdfs, n, nthread, [&](cteqpdf& pdf, Py_ssize_t lo,
+                                        Py_ssize_t hi) {
+    for (Py_ssize_t i = lo; i < hi; ++i) {
+      // range check before narrowing, other flavours give 0
+      long long fl = scalar ? flav : f.int_at(i);
+      os[i] = (xs[i] < 1.0 && fl >= -Nf && fl <= Nf)
+                  ? pdf.parton(static_cast<int>(fl), xs[i], qs[i])
+                  : 0.0;
+    }
+  });
+  Py_END_ALLOW_THREADS
+  return res;
+}
+
+// partons(x, q, out=None, nthread=1): all flavours, shape (n, 11)
+PyObject* PDF_partons(PDFObject* self, PyObject* args, PyObject* kwds) {
+  static const char* kw[] = {"x", "q", "out", "nthread", nullptr};
+  PyObject *xo, *qo, *out = nullptr;
+  int nthread = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|Oi",
+                                   const_cast<char**>(kw), &xo, &qo, &out,
+                                   &nthread) ||
+      !loaded(self))
+    return nullptr;
+  buffer x(xo, false), q(qo, false);
+  if (!input(x, "x") || !input(q, "q")) return nullptr;
+  Py_ssize_t n = x.size();
+  if (q.size() != n) {
+    PyErr_SetString(PyExc_ValueError, "x and q differ in length");
+    return nullptr;
+  }
+  const Py_ssize_t nflav = 2 * Nf + 1;
+  PyObject* res = output(out, n, nflav);
+  if (!res) return nullptr;
+  buffer o(res, true);
+  if (!check_out(o, n * nflav)) {
+    Py_DECREF(res);
+    return nullptr;
+  }
+  const double *xs = x.doubles(), *qs = q.doubles();
+  double* os = o.doubles();
+  Py_BEGIN_ALLOW_THREADS
+  std::lock_guard<std::mutex> guard(*self->lock);
+  parallel(*self->pdfs, n, nthread, [&](cteqpdf& pdf, Py_ssize_t lo,
+                                        Py_ssize_t hi) {
+    for (Py_ssize_t i = lo; i < hi; ++i)
+      for (int fl = -Nf; fl <= Nf; ++fl)
+        os[i * nflav + Nf + fl] =
+            (xs[i] < 1.0) ? pdf.parton(fl, xs[i], qs[i]) : 0.0;
+  });
+  Py_END_ALLOW_THREADS
+  return res;
+}
+
+// alphas(q, out=None, nthread=1)
+PyObject* PDF_alphas(PDFObject* self, PyObject* args, PyObject* kwds) {
+  static const char* kw[] = {"q", "out", "nthread", nullptr};
+  PyObject *qo, *out = nullptr;
+  int nthread = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Oi", const_cast<char**>(kw),
+                                   &qo, &out, &nthread) ||
+      !loaded(self))
+    return nullptr;
+  buffer q(qo, false);
+  if (!input(q, "q")) return nullptr;
+  Py_ssize_t n = q.size();
+  PyObject* res = output(out, n, 1);
+  if (!res) return nullptr;
+  buffer o(res, true);
+  if (!check_out(o, n)) {
+    Py_DECREF(res);
+    return nullptr;
+  }
+  const double* qs = q.doubles();
+  double* os = o.doubles();
+  Py_BEGIN_ALLOW_THREADS
+  std::lock_guard<std::mutex> guard(*self->lock);
+  parallel(*self->pdfs, n, nthread, [&](cteqpdf& pdf, Py_ssize_t lo,
+                                        Py_ssize_t hi) {
+    for (Py_ssize_t i = lo; i < hi; ++i) os[i] = pdf.alphas(qs[i]);
+  });
+  Py_END_ALLOW_THREADS
+  return res;
+}
+
+// jet(dx, cme, ymin, ymax, out=None, nthread=1): integrand<jet> of incjet
+// at the points dx[i] = (xa, yc, pt), without the VEGAS jacobian
+PyObject* PDF_jet(PDFObject* self, PyObject* args, PyObject* kwds) {
+  static const char* kw[] = {"dx",  "cme",     "ymin", "ymax",
+                             "out", "nthread", nullptr};
+  PyObject *dxo, *out = nullptr;
+  double cme, ymin, ymax;
+  int nthread = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oddd|Oi",
+                                   const_cast<char**>(kw), &dxo, &cme, &ymin,
+                                   &ymax, &out, &nthread) ||
+      !loaded(self))
+    return nullptr;
+  buffer dx(dxo, false);
+  if (!input(dx, "dx")) return nullptr;
+  const Py_ssize_t ndim = jet::ndim;
+  if (dx.size() % ndim != 0) {
+    PyErr_SetString(PyExc_ValueError, "dx must have shape (n, 3)");
+    return nullptr;
+  }
+  Py_ssize_t n = dx.size() / ndim;
+  PyObject* res = output(out, n, 1);
+  if (!res) return nullptr;
+  buffer o(res, true);
+  if (!check_out(o, n)) {
+    Py_DECREF(res);
+    return nullptr;
+  }
+  const double* ds = dx.doubles();
+  double* os = o.doubles();
+  Py_BEGIN_ALLOW_THREADS
+  std::lock_guard<std::mutex> guard(*self->lock);
+  parallel(*self->pdfs, n, nthread, [&](cteqpdf& pdf, Py_ssize_t lo,
+                                        Py_ssize_t hi) {
+    parameters<jet> p;
+    p.CME = cme;
+    p.ymin = ymin;
+    p.ymax = ymax;
+    p.ct18anlo = pdf;
+    double point[jet::ndim];
+    for (Py_ssize_t i = lo; i < hi; ++i) {
+      std::copy(ds + i * ndim, ds + (i + 1) * ndim, point);
+      os[i] = integrand<jet>(point, jet::ndim, &p);
+    }
+  });
+  Py_END_ALLOW_THREADS
+  return res;
+}
+
+// METH_KEYWORDS methods as PyCFunction; the cast through void (*)() is
+// the one that does not warn
+template <typename Func>
+PyCFunction method(Func f) {
+  return reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(f));
+}
+
+PyMethodDef PDF_methods[] = {
+    {"parton", method(PDF_parton),
+     METH_VARARGS | METH_KEYWORDS,
+     "parton(flavour, x, q, out=None, nthread=1): f(x, Q) of one flavour "
+     "per point"},
+    {"partons", method(PDF_partons),
+     METH_VARARGS | METH_KEYWORDS,
+     "partons(x, q, out=None, nthread=1): all flavours -5..5, shape (n, 11)"},
+    {"alphas", method(PDF_alphas),
+     METH_VARARGS | METH_KEYWORDS,
+     "alphas(q, out=None, nthread=1): strong coupling at the scales q"},
+    {"jet", method(PDF_jet),
+     METH_VARARGS | METH_KEYWORDS,
+     "jet(dx, cme, ymin, ymax, out=None, nthread=1): incjet integrand at "
+     "the points dx of shape (n, 3) = (xa, yc, pt)"},
+    {nullptr, nullptr, 0, nullptr}};
+
+// value-initialised, the fields are set in PyInit_hepkernels
+PyTypeObject PDFType{};
+
+PyModuleDef module = {PyModuleDef_HEAD_INIT, "hepkernels",
+                      "Batched CTEQ PDF and incjet integrand calls on arrays.",
+                      -1, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit_hepkernels(void) {
+  PDFType.ob_base = PyVarObject{PyObject_HEAD_INIT(nullptr) 0};
+  PDFType.tp_name = "hepkernels.PDF";
+  PDFType.tp_doc = "PDF(pdsfile): CTEQ PDF table";
+  PDFType.tp_basicsize = sizeof(PDFObject);
+  PDFType.tp_flags = Py_TPFLAGS_DEFAULT;
+  PDFType.tp_new = PyType_GenericNew;
+  PDFType.tp_init = reinterpret_cast<initproc>(PDF_init);
+  PDFType.tp_dealloc = reinterpret_cast<destructor>(PDF_dealloc);
+  PDFType.tp_methods = PDF_methods;
+  if (PyType_Ready(&PDFType) < 0) return nullptr;
+  PyObject* m = PyModule_Create(&module);
+  if (!m) return nullptr;
+  Py_INCREF(&PDFType);
+  if (PyModule_AddObject(m, "PDF", reinterpret_cast<PyObject*>(&PDFType)) <
+      0) {
+    Py_DECREF(&PDFType);
+    Py_DECREF(m);
+    return nullptr;
+  }
+  return m;
+}
@@ -0,0 +1,18 @@
+# build the hepkernels extension in place:
+#   python3 setup.py build_ext --inplace
+# needs the incjet sources (and GSL headers, included by process.h)
+from setuptools import Extension, setup
+
+setup(
+    name="hepkernels",
+    version="1.0",
+    ext_modules=[
+        Extension(
+            "hepkernels",
+            sources=["hepkernels.cpp", "../incjet/ct11pdf.cc"],
+            include_dirs=["../incjet"],
+            extra_compile_args=["-O3", "-std=c++17"],
+            language="c++",
+        )
+    ],
+)
@@ -0,0 +1,57 @@
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "timer.h"
+
+// toy "integrand" with two nested parts, timed as zones
+double partA(double x) {
+  PROFILE_ZONE("part A");
+  return std::exp(-x * x);
+}
+
+double partB(double x) {
+  PROFILE_ZONE("part B");
+  return std::log1p(x) * std::sin(x);
+}
+
+double integrand(double x) {
+  PROFILE_ZONE("integrand");
+  return partA(x) + partB(x);
+}
+
+// midpoint sum of n points on [0, 1]
+double sum(long n) {
+  PROFILE_ZONE("sum");
+  double s = 0.0;
+  for (long i = 0; i < n; ++i) s += integrand((i + 0.5) / n);
+  return s / n;
+}
+
+int main() {
+  Timer total;
+
+  // one thread
+  double r1 = sum(2000000);
+
+  // four threads, their zones are added up in the report
+  std::vector<double> r(4);
+  std::vector<std::thread> pool;
+  for (int t = 0; t < 4; ++t)
+    pool.emplace_back([&r, t] { r[t] = sum(500000); });
+  for (std::thread& th : pool) th.join();
+
+  // cost of an empty zone
+  Timer empty;
+  const long nzone = 10000000;
+  for (long i = 0; i < nzone; ++i) {
+    PROFILE_ZONE("empty zone");
+  }
+  double cost = empty.elapsed();
+
+  std::cout << "integral: " << r1 << " and " << r[0] << std::endl;
+  std::cout << "time: " << total.elapsed() << " seconds" << std::endl;
+  std::cout << "empty zone: " << 1e9 * cost / nzone << " ns" << std::endl;
+  Profile::report(std::cout);
+}
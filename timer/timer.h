@@ -0,0 +1,254 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(TIMER_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define TIMER_USE_TSC 1
+#endif
+
+// Wall-clock timing and a low-overhead hierarchical profiler.
+//
+// Timer is a stopwatch:
+//   Timer t;
+//   ...
+//   double s = t.elapsed();  // seconds since construction or reset()
+//
+// Profile zones time a scope. Zones opened inside another zone become its
+// children, so the report is a call tree with the calls, the total and the
+// self time (total minus children) of every zone:
+//   void pdf(...) {
+//     PROFILE_ZONE("pdf");
+//     ...
+//   }
+//   Profile::report(std::cout);  // after all threads are joined
+// Every thread accumulates into its own tree, without locks or atomics,
+// and the report adds up the trees of all threads by zone path. A zone
+// costs two clock reads and a short search among the children of the
+// enclosing zone. The clock is steady_clock, or with TIMER_TSC the x86
+// time-stamp counter, scaled to seconds against steady_clock, which is
+// cheaper to read on most machines (example.cpp prints the cost).
+// The zones are only compiled with -DPROFILE; otherwise PROFILE_ZONE is
+// empty and the report prints nothing.
+class Timer {
+ public:
+  Timer() : start(ticks()) {}
+  void reset() { start = ticks(); }
+  double elapsed() const { return seconds(ticks() - start); }
+
+  // raw clock: TSC cycles with TIMER_TSC on x86, otherwise nanoseconds
+  static uint64_t ticks() {
+#ifdef TIMER_USE_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+#endif
+  }
+
+  // ticks to seconds; the TSC rate is measured against steady_clock
+  // between program start and the call
+  static double seconds(uint64_t n) {
+#ifdef TIMER_USE_TSC
+    const origin& o = origin::get();
+    std::chrono::duration<double> dt =
+        std::chrono::steady_clock::now() - o.wall;
+    uint64_t dn = ticks() - o.tsc;
+    return dn > 0 ? static_cast<double>(n) * dt.count() / dn : 0.0;
+#else
+    return static_cast<double>(n) * 1e-9;
+#endif
+  }
+
+ private:
+  uint64_t start;
+#ifdef TIMER_USE_TSC
+  struct origin {
+    std::chrono::steady_clock::time_point wall;
+    uint64_t tsc;
+    static const origin& get() {
+      static const origin o{std::chrono::steady_clock::now(), __rdtsc()};
+      return o;
+    }
+  };
+  // fix the origin at program start, so the calibration spans the run
+  static inline const origin& init = origin::get();
+#endif
+};
+
+namespace Profile {
+
+// a PROFILE_ZONE in the source
+struct Site {
+  const char* name;
+};
+
+// a zone in the call tree of one thread
+struct Node {
+  const Site* site;
+  Node* parent;
+  uint64_t ticks = 0, calls = 0;
+  std::vector<std::unique_ptr<Node>> children;
+
+  Node(const Site* site, Node* parent) : site(site), parent(parent) {}
+  Node* child(const Site* s) {
+    for (const std::unique_ptr<Node>& c : children)
+      if (c->site == s) return c.get();
+    children.emplace_back(new Node(s, this));
+    return children.back().get();
+  }
+};
+
+// call tree of one thread, kept after the thread ends
+struct Tree {
+  Node root{nullptr, nullptr};
+  Node* current = &root;
+};
+
+inline std::mutex& registry_lock() {
+  static std::mutex m;
+  return m;
+}
+inline std::vector<std::unique_ptr<Tree>>& registry() {
+  static std::vector<std::unique_ptr<Tree>> trees;
+  return trees;
+}
+
+// the tree of the calling thread, registered at its first zone
+inline Tree& local() {
+  thread_local Tree* tree = nullptr;
+  if (!tree) {
+    std::lock_guard<std::mutex> guard(registry_lock());
+    registry().emplace_back(new Tree);
+    tree = registry().back().get();
+  }
+  return *tree;
+}
+
+// RAII zone, see PROFILE_ZONE
+class Zone {
+ public:
+  explicit Zone(const Site& site) : tree(local()) {
+    node = tree.current->child(&site);
+    tree.current = node;
+    start = Timer::ticks();
+  }
+  Zone(const Zone&) = delete;
+  Zone& operator=(const Zone&) = delete;
+  ~Zone() {
+    node->ticks += Timer::ticks() - start;
+    ++node->calls;
+    tree.current = node->parent;
+  }
+
+ private:
+  Tree& tree;
+  Node* node;
+  uint64_t start;
+};
+
+// zones of all threads added up by path, in the order of first appearance
+struct Sum {
+  std::string name;
+  uint64_t ticks = 0, calls = 0;
+  std::vector<Sum> children;
+
+  void add(const Node& n) {
+    for (const std::unique_ptr<Node>& c : n.children) {
+      auto it = std::find_if(
+          children.begin(), children.end(),
+          [&](const Sum& s) { return s.name == c->site->name; });
+      if (it == children.end()) {
+        children.emplace_back();
+        children.back().name = c->site->name;
+        it = children.end() - 1;
+      }
+      it->ticks += c->ticks;
+      it->calls += c->calls;
+      it->add(*c);
+    }
+  }
+};
+
+inline void print(std::ostream& out, const Sum& s, double parent, int depth) {
+  double total = Timer::seconds(s.ticks), self = total;
+  for (const Sum& c : s.children) self -= Timer::seconds(c.ticks);
+  char line[160];
+  std::snprintf(line, sizeof(line),
+                "%*s%-*s %12llu %11.4f %11.4f %6.1f%% %11.1f", 2 * depth, "",
+                30 - 2 * depth, s.name.c_str(),
+                static_cast<unsigned long long>(s.calls), total, self,
+                parent > 0.0 ? 100.0 * total / parent : 100.0,
+                s.calls ? 1e9 * total / s.calls : 0.0);
+  out << line << '\n';
+  for (const Sum& c : s.children) print(out, c, total, depth + 1);
+}
+
+// call tree of all threads; call it once the timed threads are joined
+inline void report(std::ostream& out) {
+  Sum all;
+  size_t nthread = 0;
+  {
+    std::lock_guard<std::mutex> guard(registry_lock());
+    for (const std::unique_ptr<Tree>& t : registry()) {
+      if (t->root.children.empty()) continue;
+      all.add(t->root);
+      ++nthread;
+    }
+  }
+  if (all.children.empty()) return;
+  double total = 0.0;
+  for (const Sum& c : all.children) total += Timer::seconds(c.ticks);
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-30s %12s %11s %11s %7s %11s", "zone",
+                "calls", "total [s]", "self [s]", "parent", "ns/call");
+  out << "--------------------------------------------" << '\n'
+      << " Profile of " << nthread << (nthread == 1 ? " thread" : " threads")
+      << ", times summed over threads\n"
+      << line << '\n';
+  for (const Sum& c : all.children) print(out, c, total, 0);
+  out.flush();
+}
+
+// clear all zones, e.g. after a warm-up
+inline void reset() {
+  std::lock_guard<std::mutex> guard(registry_lock());
+  for (const std::unique_ptr<Tree>& t : registry()) {
+    std::vector<Node*> stack = {&t->root};
+    while (!stack.empty()) {
+      Node* n = stack.back();
+      stack.pop_back();
+      n->ticks = n->calls = 0;
+      for (const std::unique_ptr<Node>& c : n->children)
+        stack.push_back(c.get());
+    }
+  }
+}
+
+}  // namespace Profile
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#ifdef PROFILE
+// time the rest of the enclosing scope as zone "name" (a string literal)
+#define PROFILE_ZONE(name)                                       \
+  static const Profile::Site PROFILE_CONCAT(profile_site_,       \
+                                            __LINE__){name};     \
+  Profile::Zone PROFILE_CONCAT(profile_zone_, __LINE__)(         \
+      PROFILE_CONCAT(profile_site_, __LINE__))
+#else
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#endif
+
+#endif  // TIMER_H
@@ -0,0 +1,428 @@
+#include <gsl/gsl_monte.h>
+#include <gsl/gsl_monte_miser.h>
+#include <gsl/gsl_monte_plain.h>
+#include <gsl/gsl_monte_vegas.h>
+#include <stdlib.h>
+
+#ifdef HAVE_CUBA
+#include <cuba.h>
+#endif
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cubature.h"
+
+// Benchmark of multidimensional integrators on the same test integrands.
+// Every engine is run with a growing number of evaluations (doubling)
+// until its error estimate reaches the target relative error, and the
+// run that first reaches it is reported: evaluations, wall time,
+// evaluations per second, estimated and true error. Engines with a
+// thread count are also run for every count of --threads.
+//
+// engines: gsl-vegas gsl-miser gsl-plain  (GSL, single thread)
+//          cuba-vegas cuba-suave cuba-divonne cuba-cuhre  (with -DHAVE_CUBA)
+//          native-plain  (plain MC on std::thread)
+//          native-smolyak  (sparse grid from ../gauss/cubature.h)
+
+// test integrand on a box with known integral
+struct testcase {
+  std::string name;
+  size_t dim;
+  std::vector<double> lower, upper;
+  double exact;
+  std::function<double(const double*)> f;
+};
+
+// indicator of the unit n-sphere on [-1, 1]^n, as in gsl_vegas.cpp
+testcase nsphere(size_t dim) {
+  constexpr double pi = 3.14159265358979323846;
+  testcase t;
+  t.name = "nsphere";
+  t.dim = dim;
+  t.lower.assign(dim, -1.0);
+  t.upper.assign(dim, +1.0);
+  t.exact = std::pow(pi, dim / 2.0) / std::tgamma(dim / 2.0 + 1.0);
+  t.f = [dim](const double* x) {
+    double rsq = 0.0;
+    for (size_t i = 0; i < dim; ++i) rsq += x[i] * x[i];
+    return (rsq <= 1.0) ? 1.0 : 0.0;
+  };
+  return t;
+}
+
+// smooth Gaussian peak of width 0.1 in the middle of [0, 1]^n
+testcase gausspeak(size_t dim) {
+  constexpr double sigma = 0.1;
+  testcase t;
+  t.name = "gausspeak";
+  t.dim = dim;
+  t.lower.assign(dim, 0.0);
+  t.upper.assign(dim, 1.0);
+  double one = sigma * std::sqrt(2.0 * M_PI) *
+               std::erf(0.5 / (sigma * std::sqrt(2.0)));
+  t.exact = std::pow(one, static_cast<double>(dim));
+  t.f = [dim](const double* x) {
+    double sum = 0.0;
+    for (size_t i = 0; i < dim; ++i) sum += (x[i] - 0.5) * (x[i] - 0.5);
+    return std::exp(-sum / (2.0 * sigma * sigma));
+  };
+  return t;
+}
+
+// one integration with a given budget
+struct outcome {
+  double value = 0.0, error = 0.0;
+  size_t neval = 0;
+};
+
+// one line of the report
+struct record {
+  std::string engine, integrand;
+  size_t dim;
+  unsigned threads;
+  double target;
+  outcome out;
+  double seconds;
+  double exact;
+  bool converged;
+};
+
+// engines: run test t with about n evaluations on nthread threads
+using engine = std::function<outcome(const testcase&, size_t, unsigned)>;
+
+// GSL adapter: params points to the testcase
+double gsl_integrand(double* x, size_t, void* params) {
+  return static_cast<const testcase*>(params)->f(x);
+}
+
+// GSL VEGAS: warm-up with 1/5 of the calls, then the final stage
+outcome gsl_vegas(const testcase& t, size_t n, unsigned) {
+  gsl_monte_function gmf = {&gsl_integrand, t.dim,
+                            const_cast<testcase*>(&t)};
+  std::vector<double> xl(t.lower), xu(t.upper);
+  gsl_rng* r = gsl_rng_alloc(gsl_rng_default);
+  gsl_monte_vegas_state* s = gsl_monte_vegas_alloc(t.dim);
+  gsl_monte_vegas_params vp;
+  outcome o;
+  size_t nwarm = n / 5 / 5;
+  gsl_monte_vegas_params_get(s, &vp);
+  vp.stage = 0;
+  vp.iterations = 5;
+  gsl_monte_vegas_params_set(s, &vp);
+  gsl_monte_vegas_integrate(&gmf, xl.data(), xu.data(), t.dim, nwarm, r, s,
+                            &o.value, &o.error);
+  gsl_monte_vegas_params_get(s, &vp);
+  vp.stage = 2;
+  vp.iterations = 1;
+  gsl_monte_vegas_params_set(s, &vp);
+  gsl_monte_vegas_integrate(&gmf, xl.data(), xu.data(), t.dim, n - 5 * nwarm,
+                            r, s, &o.value, &o.error);
+  gsl_monte_vegas_free(s);
+  gsl_rng_free(r);
+  o.neval = n;
+  return o;
+}
+
+outcome gsl_miser(const testcase& t, size_t n, unsigned) {
+  gsl_monte_function gmf = {&gsl_integrand, t.dim,
+                            const_cast<testcase*>(&t)};
+  gsl_rng* r = gsl_rng_alloc(gsl_rng_default);
+  gsl_monte_miser_state* s = gsl_monte_miser_alloc(t.dim);
+  outcome o;
+  gsl_monte_miser_integrate(&gmf, t.lower.data(), t.upper.data(), t.dim, n, r,
+                            s, &o.value, &o.error);
+  gsl_monte_miser_free(s);
+  gsl_rng_free(r);
+  o.neval = n;
+  return o;
+}
+
+outcome gsl_plain(const testcase& t, size_t n, unsigned) {
+  gsl_monte_function gmf = {&gsl_integrand, t.dim,
+                            const_cast<testcase*>(&t)};
+  gsl_rng* r = gsl_rng_alloc(gsl_rng_default);
+  gsl_monte_plain_state* s = gsl_monte_plain_alloc(t.dim);
+  outcome o;
+  gsl_monte_plain_integrate(&gmf, t.lower.data(), t.upper.data(), t.dim, n, r,
+                            s, &o.value, &o.error);
+  gsl_monte_plain_free(s);
+  gsl_rng_free(r);
+  o.neval = n;
+  return o;
+}
+
+// plain MC on threads, one random stream per thread; the sums stay local
+// to the thread and are stored once, so the threads do not share a cache
+// line inside the loop
+outcome native_plain(const testcase& t, size_t n, unsigned nthread) {
+  std::vector<double> sum(nthread, 0.0), sum2(nthread, 0.0);
+  auto work = [&](unsigned id) {
+    std::mt19937_64 rng(12345 + id);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<double> x(t.dim);
+    size_t first = n * id / nthread, last = n * (id + 1) / nthread;
+    double s = 0.0, s2 = 0.0;
+    for (size_t i = first; i < last; ++i) {
+      for (size_t k = 0; k < t.dim; ++k)
+        x[k] = t.lower[k] + (t.upper[k] - t.lower[k]) * u(rng);
+      double fx = t.f(x.data());
+      s += fx;
+      s2 += fx * fx;
+    }
+    sum[id] = s;
+    sum2[id] = s2;
+  };
+  std::vector<std::thread> pool;
+  for (unsigned id = 1; id < nthread; ++id) pool.emplace_back(work, id);
+  work(0);
+  for (auto& th : pool) th.join();
+  double vol = 1.0;
+  for (size_t k = 0; k < t.dim; ++k) vol *= t.upper[k] - t.lower[k];
+  double s = 0.0, s2 = 0.0;
+  for (unsigned id = 0; id < nthread; ++id) {
+    s += sum[id];
+    s2 += sum2[id];
+  }
+  double mean = s / n, var = s2 / n - mean * mean;
+  outcome o;
+  o.value = vol * mean;
+  o.error = vol * std::sqrt(std::max(var, 0.0) / n);
+  o.neval = n;
+  return o;
+}
+
+// Smolyak sparse grid of the highest level that fits in the budget together
+// with the level below, the error is the difference of the two. The grid
+// sizes are counted before building, so only these two grids are built;
+// the time includes building them. A budget that gives the same level as
+// the previous one returns the kept result, which run() then skips.
+outcome native_smolyak(const testcase& t, size_t n, unsigned nthread) {
+  static struct {
+    std::string name;
+    size_t dim = 0;
+    unsigned nthread = 0;
+    int level = -1;
+    outcome o;
+  } last;
+  auto points = [&](int l) { return Cubature::smolyak_size(t.dim, l); };
+  int level = 0;
+  while (points(level) + points(level + 1) <= static_cast<double>(n)) ++level;
+  if (t.name == last.name && t.dim == last.dim && nthread == last.nthread &&
+      level == last.level)
+    return last.o;
+  outcome o;
+  double prev = 0.0;
+  for (int l = std::max(level - 1, 0); l <= level; ++l) {
+    auto c = Cubature::smolyak(t.lower, t.upper, l);
+    double value = c.integrate(t.f, nthread);
+    o.error = std::fabs(value - prev);
+    o.value = prev = value;
+    o.neval += c.size();
+  }
+  last = {t.name, t.dim, nthread, level, o};
+  return o;
+}
+
+#ifdef HAVE_CUBA
+// Cuba integrates over the unit hypercube, map it to the box of the test
+int cuba_integrand(const int* ndim, const double x[], const int*, double f[],
+                   void* userdata) {
+  auto* t = static_cast<const testcase*>(userdata);
+  double y[64], jac = 1.0;
+  for (int k = 0; k < *ndim; ++k) {
+    double d = t->upper[k] - t->lower[k];
+    y[k] = t->lower[k] + d * x[k];
+    jac *= d;
+  }
+  f[0] = jac * t->f(y);
+  return 0;
+}
+
+// the error goal is met inside Cuba, the budget only limits it
+template <int algorithm>
+outcome cuba(const testcase& t, size_t n, unsigned nthread, double epsrel) {
+  int ncores = static_cast<int>(nthread) - 1, pcores = 10000;
+  cubacores(&ncores, &pcores);
+  int ndim = static_cast<int>(t.dim), neval = 0, fail = 0, nregions = 0;
+  int maxeval = static_cast<int>(std::min<size_t>(n, 2000000000));
+  double integral[1], error[1], prob[1];
+  void* ud = const_cast<testcase*>(&t);
+  if (algorithm == 0)
+    Vegas(ndim, 1, cuba_integrand, ud, 1, epsrel, 0.0, 0, 0, 1000, maxeval,
+          1000, 500, 1000, 0, nullptr, nullptr, &neval, &fail, integral, error,
+          prob);
+  else if (algorithm == 1)
+    Suave(ndim, 1, cuba_integrand, ud, 1, epsrel, 0.0, 0, 0, 1000, maxeval,
+          1000, 2, 25.0, nullptr, nullptr, &nregions, &neval, &fail, integral,
+          error, prob);
+  else if (algorithm == 2)
+    Divonne(ndim, 1, cuba_integrand, ud, 1, epsrel, 0.0, 0, 0, 1000, maxeval,
+            47, 1, 1, 5, 0.0, 10.0, 0.25, 0, ndim, nullptr, 0, nullptr,
+            nullptr, nullptr, &nregions, &neval, &fail, integral, error, prob);
+  else
+    Cuhre(ndim, 1, cuba_integrand, ud, 1, epsrel, 0.0, 0, 1000, maxeval, 0,
+          nullptr, nullptr, &nregions, &neval, &fail, integral, error, prob);
+  outcome o;
+  o.value = integral[0];
+  o.error = error[0];
+  o.neval = static_cast<size_t>(neval);
+  return o;
+}
+#endif
+
+// wall time of one call
+template <typename Func>
+double timed(Func&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// double the budget until the error estimate reaches the target
+record run(const std::string& name, const engine& e, const testcase& t,
+           unsigned nthread, double target, size_t maxeval) {
+  record rec{name, t.name, t.dim, nthread, target, {}, 0.0, t.exact, false};
+  for (size_t n = 1000; n <= maxeval; n *= 2) {
+    outcome o;
+    double seconds = timed([&] { o = e(t, n, nthread); });
+    if (n > 1000 && o.neval == rec.out.neval) continue;  // same run again
+    rec.seconds = seconds;
+    rec.out = o;
+    if (o.error <= target * std::fabs(o.value) && o.value != 0.0) {
+      rec.converged = true;
+      break;
+    }
+  }
+  return rec;
+}
+
+void print(std::ostream& out, const std::vector<record>& recs, bool json) {
+  out << std::setprecision(6);
+  if (json) out << "[\n";
+  else
+    out << "engine,integrand,dim,threads,target,neval,seconds,evals_per_s,"
+           "value,error_est,error_true,converged\n";
+  for (size_t i = 0; i < recs.size(); ++i) {
+    const record& r = recs[i];
+    double rate = r.seconds > 0.0 ? r.out.neval / r.seconds : 0.0;
+    double truerr = std::fabs(r.out.value - r.exact) / r.exact;
+    if (json) {
+      out << "  {\"engine\": \"" << r.engine << "\", \"integrand\": \""
+          << r.integrand << "\", \"dim\": " << r.dim
+          << ", \"threads\": " << r.threads << ", \"target\": " << r.target
+          << ", \"neval\": " << r.out.neval << ", \"seconds\": " << r.seconds
+          << ", \"evals_per_s\": " << rate << ", \"value\": " << r.out.value
+          << ", \"error_est\": " << r.out.error / std::fabs(r.exact)
+          << ", \"error_true\": " << truerr
+          << ", \"converged\": " << (r.converged ? "true" : "false") << "}"
+          << (i + 1 < recs.size() ? "," : "") << "\n";
+    } else {
+      out << r.engine << ',' << r.integrand << ',' << r.dim << ','
+          << r.threads << ',' << r.target << ',' << r.out.neval << ','
+          << r.seconds << ',' << rate << ',' << r.out.value << ','
+          << r.out.error / std::fabs(r.exact) << ',' << truerr << ','
+          << (r.converged ? 1 : 0) << "\n";
+    }
+  }
+  if (json) out << "]\n";
+}
+
+// comma separated list of numbers
+template <typename T>
+std::vector<T> parse_list(const std::string& s) {
+  std::vector<T> v;
+  std::stringstream ss(s);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    v.push_back(static_cast<T>(std::stod(item)));
+  return v;
+}
+
+// main function
+int main(int argc, char* argv[]) {
+  // command line options
+  // --json:            JSON instead of CSV
+  // --target <eps>:    relative error to reach, default 1e-3
+  // --maxeval <n>:     largest budget per engine, default 1e7
+  // --threads <list>:  thread counts for threaded engines, default 1,2,4
+  // --dims <list>:     dimensions, default 2,4,6
+  bool json = false;
+  double target = 1e-3;
+  size_t maxeval = 10000000;
+  std::vector<unsigned> threads = {1, 2, 4};
+  std::vector<size_t> dims = {2, 4, 6};
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--json") {
+      json = true;
+    } else if (arg == "--target" && i + 1 < argc) {
+      target = std::stod(argv[++i]);
+    } else if (arg == "--maxeval" && i + 1 < argc) {
+      maxeval = static_cast<size_t>(std::stod(argv[++i]));
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = parse_list<unsigned>(argv[++i]);
+    } else if (arg == "--dims" && i + 1 < argc) {
+      dims = parse_list<size_t>(argv[++i]);
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--json] [--target eps] [--maxeval n] [--threads 1,2,4]"
+                   " [--dims 2,4,6]"
+                << std::endl;
+      return 1;
+    }
+  }
+  // the Cuba integrand maps the point into a fixed array of 64
+  for (size_t dim : dims) {
+    if (dim == 0 || dim > 64) {
+      std::cerr << "Error: --dims must be between 1 and 64" << std::endl;
+      return 1;
+    }
+  }
+  gsl_rng_env_setup();
+  // single-threaded and threaded engines
+  std::vector<std::pair<std::string, engine>> serial = {
+      {"gsl-vegas", gsl_vegas}, {"gsl-miser", gsl_miser},
+      {"gsl-plain", gsl_plain}};
+  std::vector<std::pair<std::string, engine>> threaded = {
+      {"native-plain", native_plain}, {"native-smolyak", native_smolyak}};
+#ifdef HAVE_CUBA
+  threaded.push_back({"cuba-vegas", [target](const testcase& t, size_t n,
+                                             unsigned nt) {
+                        return cuba<0>(t, n, nt, target);
+                      }});
+  threaded.push_back({"cuba-suave", [target](const testcase& t, size_t n,
+                                             unsigned nt) {
+                        return cuba<1>(t, n, nt, target);
+                      }});
+  threaded.push_back({"cuba-divonne", [target](const testcase& t, size_t n,
+                                               unsigned nt) {
+                        return cuba<2>(t, n, nt, target);
+                      }});
+  threaded.push_back({"cuba-cuhre", [target](const testcase& t, size_t n,
+                                             unsigned nt) {
+                        return cuba<3>(t, n, nt, target);
+                      }});
+#endif
+  std::vector<record> recs;
+  for (size_t dim : dims) {
+    for (const testcase& t : {nsphere(dim), gausspeak(dim)}) {
+      for (const auto& e : serial)
+        recs.push_back(run(e.first, e.second, t, 1, target, maxeval));
+      for (const auto& e : threaded)
+        for (unsigned nt : threads)
+          recs.push_back(run(e.first, e.second, t, nt, target, maxeval));
+    }
+  }
+  print(std::cout, recs, json);
+  return 0;
+}